@@ -24,6 +24,7 @@
 
 #include "SolutionSpace.hpp"
 #include "AdjacentSpec.hpp"
+#include "CliqueSpec.hpp"
 
 class Clique : public SolutionSpace {
 private:
@@ -36,44 +37,49 @@ public:
 
     virtual ZBDD createSolutionSpaceZdd()
     {
-        const int n = graph_.vertexSize();
         const int m = graph_.edgeSize();
 
-        std::vector<bddvar> vararr;
         for (int i = 0; i < num_elements_; ++i) {
             BDD_NewVar();
-            vararr.push_back(i + 1);
         }
 
         double start_time = getTime();
 
-        ZBDD clique_zdd = sbddh::getPowerSet(vararr);
+        std::vector<std::pair<int, int> > edges;
+        for (int i = 0; i < m; ++i) {
+            const Graph::EdgeInfo& edge = graph_.edgeInfo(i);
+            edges.push_back(std::make_pair(edge.v1, edge.v2));
+        }
 
-        // Construct the ZDD representing all the families of cliques.
-        for (int vv1 = 1; vv1 <= n; ++vv1) {
-            for (int vv2 = vv1 + 1; vv2 <= n; ++vv2) {
-                bool found = false;
-                for (int i = 0; i < m; ++i) {
-                    const Graph::EdgeInfo& edge = graph_.edgeInfo(i);
-                    if ((edge.v1 == vv1 && edge.v2 == vv2)
-                        || (edge.v1 == vv2 && edge.v2 == vv1)) {
-                        found = true;
-                        break;
-                    }
-                }
-                if (!found) {
-                    int v1 = getVertexNumber(graph_, vv1);
-                    int v2 = getVertexNumber(graph_, vv2);
-                    AdjacentSpec aspec(v1, v2, num_elements_, true);
-                    DdStructure<2> dd(aspec);
-                    ZBDD zx = dd.evaluate(ToZBDD());
-                    clique_zdd &= zx;
-                    if (clique_zdd == ZBDD(-1)) {
-                        std::cerr << "Cannot construct the clique set ZDD due to memory shortage." << std::endl;
-                        exit(1);
+        ZBDD clique_zdd;
+        if (use_conj_) {
+            // intersect the constraints of the non-adjacent pairs
+            std::vector<std::vector<bool> > adjacent(num_elements_ + 1,
+                std::vector<bool>(num_elements_ + 1, false));
+            for (size_t i = 0; i < edges.size(); ++i) {
+                adjacent[edges[i].first][edges[i].second] = true;
+                adjacent[edges[i].second][edges[i].first] = true;
+            }
+            ConjunctionScheduler scheduler(conj_group_size_);
+            for (int v1 = 1; v1 <= num_elements_; ++v1) {
+                for (int v2 = v1 + 1; v2 <= num_elements_; ++v2) {
+                    if (!adjacent[v1][v2]) {
+                        AdjacentSpec aspec(v1, v2, num_elements_, true);
+                        DdStructure<2> dd(aspec, use_mp_);
+                        scheduler.add(dd.evaluate(ToZBDD()), v1, v2);
                     }
                 }
             }
+            clique_zdd = conjoinConstraints(scheduler, show_info_);
+        } else {
+            // Construct the ZDD representing all the families of cliques.
+            CliqueSpec cspec(edges, num_elements_);
+            DdStructure<2> dd(cspec, use_mp_);
+            clique_zdd = dd.evaluate(ToZBDD());
+        }
+        if (clique_zdd == ZBDD(-1)) {
+            std::cerr << "Cannot construct the clique set ZDD due to memory shortage." << std::endl;
+            exit(1);
         }
         double end_time = getTime();
 
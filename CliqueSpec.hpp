@@ -0,0 +1,129 @@
+//
+// CliqueSpec.hpp
+//
+// Copyright (c) 2020 -- 2022 Jun Kawahara and project "Fusion of Computer Science, Engineering
+//     and Mathematics Approaches for Expanding Combinatorial Reconfiguration"
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+// and associated documentation files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+// BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef CLIQUE_SPEC_HPP
+#define CLIQUE_SPEC_HPP
+
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <cassert>
+
+// The family of all the cliques of a graph whose vertex v corresponds to
+// the variable at level v. The state is the list of the chosen vertices
+// in the descending order. Once a vertex is chosen, only the common
+// neighbors of the chosen vertices are visited, and the levels of the
+// other vertices are skipped (that is, they are not chosen).
+class CliqueSpec : public tdzdd::PodArrayDdSpec<CliqueSpec, int, 2> {
+private:
+    const int n_;
+    // adjacent_[u][v] is true iff u and v are adjacent
+    std::vector<std::vector<bool> > adjacent_;
+    // lower_[v]: the neighbors of v smaller than v in the descending order
+    std::vector<std::vector<int> > lower_;
+    // an upper bound on the size of a clique
+    int max_size_;
+
+    // Return the largest vertex w < v adjacent to all the chosen vertices
+    // data[0], ..., data[size - 1], or 0 if there is no such vertex.
+    int getNextCandidate(const int* data, int size, int v) const
+    {
+        if (size == 0) {
+            return v - 1;
+        }
+        // data[size - 1] is the smallest chosen vertex, and v <= it.
+        const std::vector<int>& lower = lower_[data[size - 1]];
+        for (size_t i = 0; i < lower.size(); ++i) {
+            int w = lower[i];
+            if (w >= v) {
+                continue;
+            }
+            bool is_common = true;
+            for (int j = 0; j < size - 1; ++j) {
+                if (!adjacent_[data[j]][w]) {
+                    is_common = false;
+                    break;
+                }
+            }
+            if (is_common) {
+                return w;
+            }
+        }
+        return 0;
+    }
+
+    int getSize(const int* data) const
+    {
+        int size = 0;
+        while (size < max_size_ && data[size] != 0) {
+            ++size;
+        }
+        return size;
+    }
+
+public:
+    // edges[i] is the i-th edge. Self-loops and multiple edges are ignored.
+    CliqueSpec(const std::vector<std::pair<int, int> >& edges, int n)
+        : n_(n), adjacent_(n + 1, std::vector<bool>(n + 1, false)),
+          lower_(n + 1), max_size_(1)
+    {
+        for (size_t i = 0; i < edges.size(); ++i) {
+            int u = edges[i].first;
+            int v = edges[i].second;
+            if (u == v || adjacent_[u][v]) {
+                continue;
+            }
+            adjacent_[u][v] = true;
+            adjacent_[v][u] = true;
+            lower_[std::max(u, v)].push_back(std::min(u, v));
+        }
+        for (int v = 1; v <= n_; ++v) {
+            std::sort(lower_[v].begin(), lower_[v].end(),
+                      std::greater<int>());
+            // The largest vertex of a clique is adjacent to all the others.
+            max_size_ = std::max(max_size_,
+                                 static_cast<int>(lower_[v].size()) + 1);
+        }
+        setArraySize(max_size_);
+    }
+
+    int getRoot(int* data) const
+    {
+        for (int i = 0; i < max_size_; ++i) {
+            data[i] = 0;
+        }
+        return (n_ >= 1 ? n_ : -1);
+    }
+
+    int getChild(int* data, int level, int value) const
+    {
+        int size = getSize(data);
+        if (value == 1) {
+            assert(size < max_size_);
+            data[size] = level;
+            ++size;
+        }
+        int next = getNextCandidate(data, size, level);
+        return (next >= 1 ? next : -1);
+    }
+};
+
+#endif // CLIQUE_SPEC_HPP
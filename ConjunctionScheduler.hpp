@@ -0,0 +1,160 @@
+//
+// ConjunctionScheduler.hpp
+//
+// Copyright (c) 2020 -- 2022 Jun Kawahara and project "Fusion of Computer Science, Engineering
+//     and Mathematics Approaches for Expanding Combinatorial Reconfiguration"
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+// and associated documentation files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+// BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef CONJUNCTION_SCHEDULER_HPP
+#define CONJUNCTION_SCHEDULER_HPP
+
+#include <vector>
+#include <queue>
+#include <algorithm>
+
+// Compute the intersection of the ZDDs of many constraints. Instead of
+// intersecting an accumulator with the constraints one by one, the two
+// smallest ZDDs are repeatedly replaced with their intersection, so
+// that the intersections form a balanced tree when the ZDDs have
+// similar sizes. Optionally, the constraints are first sorted by the
+// levels they depend on and every group_size consecutive constraints
+// are intersected, so that the constraints on close variables are
+// combined early.
+class ConjunctionScheduler {
+private:
+    struct Constraint {
+        ZBDD f;
+        size_t size;
+        // the constraint depends only on the levels in [low, high]
+        int low;
+        int high;
+    };
+
+    struct SizeGreater {
+        bool operator()(const Constraint& c1, const Constraint& c2) const
+        {
+            return c1.size > c2.size;
+        }
+    };
+
+    struct LevelGreater {
+        bool operator()(const Constraint& c1, const Constraint& c2) const
+        {
+            if (c1.high != c2.high) {
+                return c1.high > c2.high;
+            }
+            return c1.low > c2.low;
+        }
+    };
+
+    std::vector<Constraint> constraints_;
+    int group_size_;
+    // the maximum number of nodes of an intermediate ZDD
+    size_t peak_size_;
+
+    Constraint intersect(const Constraint& c1, const Constraint& c2)
+    {
+        Constraint c;
+        c.f = c1.f & c2.f;
+        if (c.f == ZBDD(-1)) {
+            std::cerr << "Cannot construct a ZDD due to memory shortage."
+                      << std::endl;
+            exit(1);
+        }
+        c.size = c.f.Size();
+        c.low = std::min(c1.low, c2.low);
+        c.high = std::max(c1.high, c2.high);
+        peak_size_ = std::max(peak_size_, c.size);
+        return c;
+    }
+
+    // Intersect constraints[begin], ..., constraints[end - 1] in the
+    // balanced binary tree over this order.
+    Constraint intersectRange(const std::vector<Constraint>& constraints,
+                              size_t begin, size_t end)
+    {
+        if (end - begin == 1) {
+            return constraints[begin];
+        }
+        size_t mid = begin + (end - begin) / 2;
+        return intersect(intersectRange(constraints, begin, mid),
+                         intersectRange(constraints, mid, end));
+    }
+
+public:
+    // If group_size >= 2, the constraints are grouped by their levels.
+    explicit ConjunctionScheduler(int group_size = 0)
+        : group_size_(group_size), peak_size_(0) { }
+
+    // Add the constraint f, which depends only on the levels
+    // in [low, high].
+    void add(const ZBDD& f, int low, int high)
+    {
+        Constraint c;
+        c.f = f;
+        c.size = f.Size();
+        c.low = low;
+        c.high = high;
+        peak_size_ = std::max(peak_size_, c.size);
+        constraints_.push_back(c);
+    }
+
+    size_t getNumConstraints() const
+    {
+        return constraints_.size();
+    }
+
+    size_t getPeakSize() const
+    {
+        return peak_size_;
+    }
+
+    // Return the intersection of all the constraints and remove them.
+    // If there is no constraint, unit_zdd is returned.
+    ZBDD conjoin(const ZBDD& unit_zdd)
+    {
+        if (constraints_.empty()) {
+            return unit_zdd;
+        }
+        std::vector<Constraint> constraints;
+        if (group_size_ >= 2) {
+            std::sort(constraints_.begin(), constraints_.end(),
+                      LevelGreater());
+            for (size_t i = 0; i < constraints_.size();
+                 i += group_size_) {
+                size_t end = std::min(i + group_size_, constraints_.size());
+                constraints.push_back(intersectRange(constraints_, i, end));
+            }
+        } else {
+            constraints.swap(constraints_);
+        }
+        constraints_.clear();
+
+        std::priority_queue<Constraint, std::vector<Constraint>,
+                            SizeGreater> queue(SizeGreater(), constraints);
+        while (queue.size() >= 2) {
+            Constraint c1 = queue.top();
+            queue.pop();
+            Constraint c2 = queue.top();
+            queue.pop();
+            queue.push(intersect(c1, c2));
+        }
+        return queue.top().f;
+    }
+};
+
+#endif // CONJUNCTION_SCHEDULER_HPP
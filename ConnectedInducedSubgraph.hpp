@@ -47,7 +47,7 @@ public:
     virtual ZBDD createSolutionSpaceZdd()
     {
         ConnectedInducedSubgraphSpec cis_spec(graph_, true);
-        DdStructure<2> dd_E = DdStructure<2>(cis_spec);
+        DdStructure<2> dd_E = DdStructure<2>(cis_spec, use_mp_);
         dd_E.zddReduce();
 
         if (is_vertex_variable_) {
@@ -0,0 +1,104 @@
+//
+// CountFamily.hpp
+//
+// Copyright (c) 2020 -- 2022 Jun Kawahara and project "Fusion of Computer Science, Engineering
+//     and Mathematics Approaches for Expanding Combinatorial Reconfiguration"
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+// and associated documentation files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+// BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef COUNT_FAMILY_HPP
+#define COUNT_FAMILY_HPP
+
+#include <vector>
+#include <set>
+#include <cassert>
+
+// A family of sets each of which has a nonnegative integer count,
+// represented by the binary digits of the counts. The count of a set X
+// is the sum of 2^b over the digits b with X in digits[b]. Counts are
+// added by ZDD operations, so no set is enumerated.
+typedef std::vector<ZBDD> CountFamily;
+
+// *a += b (setwise)
+inline void addCountFamily(CountFamily* a, const CountFamily& b)
+{
+    ZBDD carry(0);
+    for (size_t i = 0; i < b.size() || carry != ZBDD(0); ++i) {
+        if (i == a->size()) {
+            a->push_back(ZBDD(0));
+        }
+        ZBDD x = (*a)[i];
+        ZBDD y = (i < b.size() ? b[i] : ZBDD(0));
+        ZBDD sum = (x - y) + (y - x);
+        (*a)[i] = (sum - carry) + (carry - sum);
+        carry = (x & y) + (sum & carry);
+    }
+}
+
+// the count family whose counts are those of c for the sets in f
+// and zero for the others
+inline CountFamily restrictCountFamily(const CountFamily& c, const ZBDD& f)
+{
+    CountFamily result;
+    for (size_t i = 0; i < c.size(); ++i) {
+        result.push_back(c[i] & f);
+    }
+    return result;
+}
+
+// the count of s in c
+inline BigInteger getCount(const CountFamily& c, const std::set<bddvar>& s)
+{
+    BigInteger count(0);
+    BigInteger power(1);
+    for (size_t i = 0; i < c.size(); ++i) {
+        if (isMemberZ(c[i], s)) {
+            count += power;
+        }
+        power += power;
+    }
+    return count;
+}
+
+// Pick a set of c with probability proportional to its count. A digit b
+// is chosen with probability proportional to 2^b |digits[b]|, and then
+// a set of digits[b] is chosen uniformly. c must have a positive count.
+inline std::set<bddvar> sampleCountFamily(const CountFamily& c,
+                                          BigIntegerRandom& random)
+{
+    std::vector<BigInteger> weights;
+    BigInteger total(0);
+    for (size_t i = 0; i < c.size(); ++i) {
+        BigInteger weight = ZBDD_CountSolutions(c[i]);
+        for (size_t j = 0; j < i; ++j) { // weight *= 2
+            weight += weight;
+        }
+        weights.push_back(weight);
+        total += weight;
+    }
+    BigInteger r = random.GetRand(total);
+    BigInteger acc(0);
+    for (size_t i = 0; i < c.size(); ++i) {
+        acc += weights[i];
+        if (r < acc) {
+            return pickRandomly(c[i], random);
+        }
+    }
+    assert(false);
+    return std::set<bddvar>();
+}
+
+#endif // COUNT_FAMILY_HPP
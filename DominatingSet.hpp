@@ -24,6 +24,7 @@
 
 #include "SolutionSpace.hpp"
 #include "VariableConditionSpec.hpp"
+#include "DominatingSetSpec.hpp"
 #include "ConnectedInducedSubgraph.hpp"
 
 class DominatingSet : public SolutionSpace {
@@ -44,40 +45,45 @@ public:
     {
         const int m = graph_.edgeSize();
 
-        std::vector<bddvar> vararr;
         for (int i = 0; i < num_elements_; ++i) {
             BDD_NewVar();
-            vararr.push_back(i + 1);
         }
 
-        ZBDD dominating_set_zdd = sbddh::getPowerSet(vararr);
-
-        for (int v = 1; v <= num_elements_; ++v) {
-            std::set<int> s;
-            s.insert(v);
+        std::vector<std::vector<int> > adjacent_lists(num_elements_ + 1);
+        for (int i = 0; i < m; ++i) {
+            const Graph::EdgeInfo& edge = graph_.edgeInfo(i);
+            adjacent_lists[edge.v1].push_back(edge.v2);
+            adjacent_lists[edge.v2].push_back(edge.v1);
+        }
 
-            // insert all the neighbors of v into s
-            for (int j = 0; j < m; ++j) {
-                const Graph::EdgeInfo& edge = graph_.edgeInfo(j);
-                if (edge.v1 == v) {
-                    s.insert(edge.v2);
-                } else if (edge.v2 == v) {
-                    s.insert(edge.v1);
-                }
-            }
-            VariableConditionSpec vcspec(s, num_elements_,
-                                         VariableConditionKind::AT_LEAST_ONE);
-            DdStructure<2> dd(vcspec);
-            ZBDD zx = dd.evaluate(ToZBDD());
-            dominating_set_zdd &= zx;
-            if (dominating_set_zdd == ZBDD(-1)) {
-                std::cerr << "Cannot construct the dominating set ZDD due to memory shortage." << std::endl;
-                exit(1);
+        ZBDD dominating_set_zdd;
+        if (use_conj_) {
+            // intersect the constraints that each closed neighborhood
+            // contains a chosen vertex
+            ConjunctionScheduler scheduler(conj_group_size_);
+            for (int v = 1; v <= num_elements_; ++v) {
+                std::set<int> s(adjacent_lists[v].begin(),
+                                adjacent_lists[v].end());
+                s.insert(v);
+                VariableConditionSpec vcspec(s, num_elements_,
+                                             VariableConditionKind::AT_LEAST_ONE);
+                DdStructure<2> dd(vcspec, use_mp_);
+                scheduler.add(dd.evaluate(ToZBDD()), *s.begin(), *s.rbegin());
             }
+            dominating_set_zdd = conjoinConstraints(scheduler, show_info_);
+        } else {
+            DominatingSetSpec dspec(adjacent_lists, num_elements_);
+            DdStructure<2> dd(dspec, use_mp_);
+            dominating_set_zdd = dd.evaluate(ToZBDD());
+        }
+        if (dominating_set_zdd == ZBDD(-1)) {
+            std::cerr << "Cannot construct the dominating set ZDD due to memory shortage." << std::endl;
+            exit(1);
         }
 
         if (is_connected_) {
             ConnectedInducedSubgraph cis(graph_, true, show_info_);
+            cis.setUseMultiProcessors(use_mp_);
             dominating_set_zdd &= cis.createSolutionSpaceZdd();
         }
 
@@ -0,0 +1,143 @@
+//
+// DominatingSetSpec.hpp
+//
+// Copyright (c) 2020 -- 2022 Jun Kawahara and project "Fusion of Computer Science, Engineering
+//     and Mathematics Approaches for Expanding Combinatorial Reconfiguration"
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+// and associated documentation files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+// BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef DOMINATING_SET_SPEC_HPP
+#define DOMINATING_SET_SPEC_HPP
+
+#include <vector>
+#include <set>
+#include <algorithm>
+
+typedef unsigned char DominatingSetSpecData;
+
+// The family of all the dominating sets of a graph whose vertex v
+// corresponds to the variable at level v. The graph is given by
+// adjacency lists. Vertex u is on the frontier from level max N[u]
+// to level min N[u], where N[u] is the closed neighborhood of u,
+// and the state stores whether each vertex on the frontier is
+// dominated by a chosen vertex.
+class DominatingSetSpec
+    : public tdzdd::PodArrayDdSpec<DominatingSetSpec, DominatingSetSpecData, 2> {
+private:
+    const int n_;
+
+    // closed_[v]: the closed neighborhood N[v] of v
+    std::vector<std::vector<int> > closed_;
+    // entering_[v]: the vertices u with max N[u] = v
+    std::vector<std::vector<int> > entering_;
+    // leaving_[v]: the vertices u with min N[u] = v
+    std::vector<std::vector<int> > leaving_;
+    // pos_[u]: the position of u in the state
+    std::vector<int> pos_;
+    int max_frontier_size_;
+
+    void construct(const std::vector<std::vector<int> >& adjacent_lists)
+    {
+        closed_.assign(n_ + 1, std::vector<int>());
+        entering_.assign(n_ + 1, std::vector<int>());
+        leaving_.assign(n_ + 1, std::vector<int>());
+        pos_.assign(n_ + 1, -1);
+
+        for (int u = 1; u <= n_; ++u) {
+            std::set<int> neighbors(adjacent_lists[u].begin(),
+                                    adjacent_lists[u].end());
+            neighbors.insert(u);
+            closed_[u].assign(neighbors.begin(), neighbors.end());
+            leaving_[*neighbors.begin()].push_back(u);
+            entering_[*neighbors.rbegin()].push_back(u);
+        }
+
+        // assign the positions, reusing those of the left vertices
+        std::vector<int> unused;
+        int frontier_size = 0;
+        max_frontier_size_ = 0;
+        for (int v = n_; v >= 1; --v) {
+            for (size_t i = 0; i < entering_[v].size(); ++i) {
+                int u = entering_[v][i];
+                if (unused.empty()) {
+                    pos_[u] = max_frontier_size_;
+                } else {
+                    pos_[u] = unused.back();
+                    unused.pop_back();
+                }
+                ++frontier_size;
+                max_frontier_size_ = std::max(max_frontier_size_,
+                                              frontier_size);
+            }
+            for (size_t i = 0; i < leaving_[v].size(); ++i) {
+                unused.push_back(pos_[leaving_[v][i]]);
+                --frontier_size;
+            }
+        }
+    }
+
+public:
+    // adjacent_lists[v] (1 <= v <= n) stores the neighbors of v.
+    // Self-loops and multiple edges are ignored.
+    DominatingSetSpec(const std::vector<std::vector<int> >& adjacent_lists,
+                      int n)
+        : n_(n)
+    {
+        construct(adjacent_lists);
+        setArraySize(std::max(max_frontier_size_, 1));
+    }
+
+    // the maximum number of vertices on the frontier
+    int getMaxFrontierSize() const
+    {
+        return max_frontier_size_;
+    }
+
+    int getRoot(DominatingSetSpecData* data) const
+    {
+        for (int i = 0; i < std::max(max_frontier_size_, 1); ++i) {
+            data[i] = 0;
+        }
+        return (n_ >= 1 ? n_ : -1);
+    }
+
+    int getChild(DominatingSetSpecData* data, int level, int value) const
+    {
+        const int v = level;
+        if (value == 1) {
+            // v dominates all the vertices in N[v]
+            const std::vector<int>& closed = closed_[v];
+            for (size_t i = 0; i < closed.size(); ++i) {
+                data[pos_[closed[i]]] = 1;
+            }
+        }
+        // A vertex u leaving the frontier is never dominated later.
+        for (size_t i = 0; i < leaving_[v].size(); ++i) {
+            int p = pos_[leaving_[v][i]];
+            if (data[p] == 0) {
+                return 0;
+            }
+            data[p] = 0;
+        }
+        if (level == 1) {
+            return -1;
+        } else {
+            return level - 1;
+        }
+    }
+};
+
+#endif // DOMINATING_SET_SPEC_HPP
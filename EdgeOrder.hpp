@@ -0,0 +1,87 @@
+//
+// EdgeOrder.hpp
+//
+// Copyright (c) 2020 -- 2022 Jun Kawahara and project "Fusion of Computer Science, Engineering
+//     and Mathematics Approaches for Expanding Combinatorial Reconfiguration"
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+// and associated documentation files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+// BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef EDGE_ORDER_HPP
+#define EDGE_ORDER_HPP
+
+#include <vector>
+#include <set>
+
+#include "VertexOrder.hpp"
+
+// Reordering of the edges of a graph for the solution spaces whose
+// variables are edges. The frontier-based constructions process the
+// edges in the order of the tdzdd::Graph, so the graph is rebuilt with
+// the edges sorted along the Cuthill-McKee order of the vertices (see
+// reorderGraph). Edge numbers (1 origin) seen by the user are those of
+// the input file, and they are translated by the following functions.
+
+// Rebuild graph into new_graph with the reordered edges.
+// edge_numbers[j] is set to the edge number of graph (1 origin) that
+// becomes the edge j of new_graph (1 origin). edge_numbers[0] is unused.
+inline void reorderEdges(const Graph& graph, Graph* new_graph,
+                         std::vector<int>* edge_numbers)
+{
+    std::vector<int> edge_order;
+    reorderGraph(graph, getCuthillMcKeeOrder(graph), new_graph, &edge_order);
+    edge_numbers->assign(1, 0);
+    for (size_t j = 0; j < edge_order.size(); ++j) {
+        edge_numbers->push_back(edge_order[j] + 1);
+    }
+}
+
+// translate the edge numbers of the input in s into the reordered ones
+inline std::set<bddvar> remapEdgeSet(const std::set<bddvar>& s,
+                                     const std::vector<int>& edge_numbers)
+{
+    std::vector<bddvar> new_numbers(edge_numbers.size(), 0);
+    for (size_t j = 1; j < edge_numbers.size(); ++j) {
+        new_numbers[edge_numbers[j]] = j;
+    }
+    std::set<bddvar> ns;
+    for (std::set<bddvar>::const_iterator itor = s.begin();
+         itor != s.end(); ++itor) {
+        if (*itor < 1 || *itor >= new_numbers.size()) {
+            std::cerr << "Edge " << *itor << " does not exist." << std::endl;
+            exit(1);
+        }
+        ns.insert(new_numbers[*itor]);
+    }
+    return ns;
+}
+
+// translate the reordered edge numbers in s into those of the input
+// (s is returned as it is if edge_numbers is empty)
+inline std::set<bddvar> restoreEdgeSet(const std::set<bddvar>& s,
+                                       const std::vector<int>& edge_numbers)
+{
+    if (edge_numbers.empty()) {
+        return s;
+    }
+    std::set<bddvar> ns;
+    for (std::set<bddvar>::const_iterator itor = s.begin();
+         itor != s.end(); ++itor) {
+        ns.insert(edge_numbers[*itor]);
+    }
+    return ns;
+}
+
+#endif // EDGE_ORDER_HPP
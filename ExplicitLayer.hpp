@@ -0,0 +1,100 @@
+//
+// ExplicitLayer.hpp
+//
+// Copyright (c) 2020 -- 2022 Jun Kawahara and project "Fusion of Computer Science, Engineering
+//     and Mathematics Approaches for Expanding Combinatorial Reconfiguration"
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+// and associated documentation files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+// BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef EXPLICIT_LAYER_HPP
+#define EXPLICIT_LAYER_HPP
+
+#include <vector>
+#include <set>
+#include <unordered_set>
+
+// A subset of {1,...,n} stored as a bitset packed into 64-bit words.
+class PackedSet {
+private:
+    std::vector<unsigned long long> words_;
+
+public:
+    explicit PackedSet(int n) : words_(n / 64 + 1, 0ull) { }
+
+    PackedSet(int n, const std::set<bddvar>& s) : words_(n / 64 + 1, 0ull)
+    {
+        for (std::set<bddvar>::const_iterator itor = s.begin();
+             itor != s.end(); ++itor) {
+            set(*itor);
+        }
+    }
+
+    bool test(int v) const
+    {
+        return ((words_[v >> 6] >> (v & 63)) & 1ull) != 0;
+    }
+
+    void set(int v)
+    {
+        words_[v >> 6] |= (1ull << (v & 63));
+    }
+
+    void reset(int v)
+    {
+        words_[v >> 6] &= ~(1ull << (v & 63));
+    }
+
+    std::set<bddvar> toSet() const
+    {
+        std::set<bddvar> s;
+        for (size_t i = 0; i < words_.size(); ++i) {
+            unsigned long long w = words_[i];
+            for (int j = 0; w != 0; ++j, w >>= 1) {
+                if ((w & 1ull) != 0) {
+                    s.insert(static_cast<bddvar>(i * 64 + j));
+                }
+            }
+        }
+        return s;
+    }
+
+    bool operator==(const PackedSet& other) const
+    {
+        return words_ == other.words_;
+    }
+
+    size_t hash() const
+    {
+        unsigned long long h = 14695981039346656037ull;
+        for (size_t i = 0; i < words_.size(); ++i) {
+            h = (h ^ words_[i]) * 1099511628211ull;
+            h ^= (h >> 29);
+        }
+        return static_cast<size_t>(h);
+    }
+};
+
+struct PackedSetHash {
+    size_t operator()(const PackedSet& s) const
+    {
+        return s.hash();
+    }
+};
+
+// A layer of the search stored explicitly (see Reconf::reconfigureExplicit)
+typedef std::unordered_set<PackedSet, PackedSetHash> ExplicitLayer;
+
+#endif // EXPLICIT_LAYER_HPP
@@ -106,11 +106,11 @@ public:
                 }
             }
 
-            dd = DdStructure<2>(dc);
+            dd = DdStructure<2>(dc, use_mp_);
             // compute the intersection of dc and fbs
             dd.zddSubset(fbs);
         } else {
-            dd = DdStructure<2>(fbs);
+            dd = DdStructure<2>(fbs, use_mp_);
         }
 
         if (is_rainbow_) { // for rainbow (spanning) trees
@@ -24,6 +24,7 @@
 
 #include "SolutionSpace.hpp"
 #include "AdjacentSpec.hpp"
+#include "IndependentSetSpec.hpp"
 #include "ConnectedInducedSubgraph.hpp"
 
 class IndependentSet : public SolutionSpace {
@@ -48,32 +49,47 @@ public:
     {
         const int m = graph_.edgeSize();
 
-        std::vector<bddvar> vararr;
         for (int i = 0; i < num_elements_; ++i) {
             BDD_NewVar();
-            vararr.push_back(i + 1);
         }
 
-        ZBDD independent_set_zdd = sbddh::getPowerSet(vararr);
-
-        // Construct the ZDD representing all the families of independent sets.
+        std::vector<std::vector<int> > adjacent_lists(num_elements_ + 1);
         for (int i = 0; i < m; ++i) {
             const Graph::EdgeInfo& edge = graph_.edgeInfo(i);
+            adjacent_lists[edge.v1].push_back(edge.v2);
+            adjacent_lists[edge.v2].push_back(edge.v1);
+        }
 
-            //int v1 = getVertexNumber(graph_, edge.v1);
-            //int v2 = getVertexNumber(graph_, edge.v2);
-            AdjacentSpec aspec(edge.v1, edge.v2, num_elements_, is_independent_set_);
-            DdStructure<2> dd(aspec);
-            ZBDD zx = dd.evaluate(ToZBDD());
-            independent_set_zdd &= zx;
-            if (independent_set_zdd == ZBDD(-1)) {
-                std::cerr << "Cannot construct the indepndent set ZDD due to memory shortage." << std::endl;
-                exit(1);
+        ZBDD independent_set_zdd;
+        if (use_conj_) {
+            // intersect the constraints of the edges
+            ConjunctionScheduler scheduler(conj_group_size_);
+            for (int i = 0; i < m; ++i) {
+                const Graph::EdgeInfo& edge = graph_.edgeInfo(i);
+                AdjacentSpec aspec(edge.v1, edge.v2, num_elements_,
+                                   is_independent_set_);
+                DdStructure<2> dd(aspec, use_mp_);
+                scheduler.add(dd.evaluate(ToZBDD()),
+                              std::min(edge.v1, edge.v2),
+                              std::max(edge.v1, edge.v2));
             }
+            independent_set_zdd = conjoinConstraints(scheduler, show_info_);
+        } else {
+            // Construct the ZDD representing all the families of
+            // independent sets (or vertex covers) at once.
+            IndependentSetSpec ispec(adjacent_lists, num_elements_,
+                                     is_independent_set_);
+            DdStructure<2> dd(ispec, use_mp_);
+            independent_set_zdd = dd.evaluate(ToZBDD());
+        }
+        if (independent_set_zdd == ZBDD(-1)) {
+            std::cerr << "Cannot construct the indepndent set ZDD due to memory shortage." << std::endl;
+            exit(1);
         }
 
         if (is_connected_) {
             ConnectedInducedSubgraph cis(graph_, true, show_info_);
+            cis.setUseMultiProcessors(use_mp_);
             independent_set_zdd &= cis.createSolutionSpaceZdd();
         }
 
@@ -0,0 +1,160 @@
+//
+// IndependentSetSpec.hpp
+//
+// Copyright (c) 2020 -- 2022 Jun Kawahara and project "Fusion of Computer Science, Engineering
+//     and Mathematics Approaches for Expanding Combinatorial Reconfiguration"
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+// and associated documentation files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+// BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef INDEPENDENT_SET_SPEC_HPP
+#define INDEPENDENT_SET_SPEC_HPP
+
+#include <vector>
+#include <set>
+#include <algorithm>
+
+typedef unsigned char IndependentSetSpecData;
+
+// The family of all the independent sets (or all the vertex covers) of
+// a graph whose vertex v corresponds to the variable at level v.
+// The graph is given by adjacency lists. All the edges are checked in
+// one top-down construction. The frontier at level l consists of
+// the decided vertices (> l) having an undecided neighbor (<= l),
+// and the state stores whether each of them is chosen.
+class IndependentSetSpec
+    : public tdzdd::PodArrayDdSpec<IndependentSetSpec, IndependentSetSpecData, 2> {
+private:
+    const int n_;
+
+    // true -> no two adjacent vertices are chosen (independent set)
+    // false -> at least one endpoint of each edge is chosen (vertex cover)
+    const bool is_independent_set_;
+
+    // upper_[v]: the neighbors of v that are larger than v
+    std::vector<std::vector<int> > upper_;
+    // leaving_[v]: the vertices leaving the frontier after v is decided
+    std::vector<std::vector<int> > leaving_;
+    // pos_[v]: the position of v in the state, or -1 if v never enters
+    //          the frontier
+    std::vector<int> pos_;
+    int max_frontier_size_;
+
+    void construct(const std::vector<std::vector<int> >& adjacent_lists)
+    {
+        upper_.assign(n_ + 1, std::vector<int>());
+        leaving_.assign(n_ + 1, std::vector<int>());
+        pos_.assign(n_ + 1, -1);
+
+        // lowest[v]: the smallest neighbor of v that is smaller than v
+        std::vector<int> lowest(n_ + 1, 0);
+        for (int v = 1; v <= n_; ++v) {
+            std::set<int> neighbors(adjacent_lists[v].begin(),
+                                    adjacent_lists[v].end());
+            for (std::set<int>::const_iterator itor = neighbors.begin();
+                 itor != neighbors.end(); ++itor) {
+                int u = *itor;
+                if (u > v) {
+                    upper_[v].push_back(u);
+                } else if (u < v && lowest[v] == 0) {
+                    lowest[v] = u;
+                }
+            }
+            if (lowest[v] > 0) {
+                leaving_[lowest[v]].push_back(v);
+            }
+        }
+
+        // assign the positions, reusing those of the left vertices
+        std::vector<int> unused;
+        int frontier_size = 0;
+        max_frontier_size_ = 0;
+        for (int v = n_; v >= 1; --v) {
+            for (size_t i = 0; i < leaving_[v].size(); ++i) {
+                unused.push_back(pos_[leaving_[v][i]]);
+                --frontier_size;
+            }
+            if (lowest[v] > 0) {
+                if (unused.empty()) {
+                    pos_[v] = max_frontier_size_;
+                } else {
+                    pos_[v] = unused.back();
+                    unused.pop_back();
+                }
+                ++frontier_size;
+                max_frontier_size_ = std::max(max_frontier_size_,
+                                              frontier_size);
+            }
+        }
+    }
+
+public:
+    // adjacent_lists[v] (1 <= v <= n) stores the neighbors of v.
+    // Self-loops and multiple edges are ignored.
+    IndependentSetSpec(const std::vector<std::vector<int> >& adjacent_lists,
+                       int n, bool is_independent_set)
+        : n_(n), is_independent_set_(is_independent_set)
+    {
+        construct(adjacent_lists);
+        setArraySize(std::max(max_frontier_size_, 1));
+    }
+
+    // the maximum number of vertices on the frontier
+    int getMaxFrontierSize() const
+    {
+        return max_frontier_size_;
+    }
+
+    int getRoot(IndependentSetSpecData* data) const
+    {
+        for (int i = 0; i < std::max(max_frontier_size_, 1); ++i) {
+            data[i] = 0;
+        }
+        return (n_ >= 1 ? n_ : -1);
+    }
+
+    int getChild(IndependentSetSpecData* data, int level, int value) const
+    {
+        const int v = level;
+        const std::vector<int>& upper = upper_[v];
+        for (size_t i = 0; i < upper.size(); ++i) {
+            bool is_chosen = (data[pos_[upper[i]]] != 0);
+            if (is_independent_set_) {
+                if (value == 1 && is_chosen) {
+                    return 0;
+                }
+            } else {
+                if (value == 0 && !is_chosen) {
+                    return 0;
+                }
+            }
+        }
+        // clear the positions of the leaving vertices so that
+        // equivalent states are shared
+        for (size_t i = 0; i < leaving_[v].size(); ++i) {
+            data[pos_[leaving_[v][i]]] = 0;
+        }
+        if (pos_[v] >= 0) {
+            data[pos_[v]] = static_cast<IndependentSetSpecData>(value);
+        }
+        if (level == 1) {
+            return -1;
+        } else {
+            return level - 1;
+        }
+    }
+};
+
+#endif // INDEPENDENT_SET_SPEC_HPP
@@ -45,7 +45,7 @@ public:
         IntRange range((is_complete_ ? 1 : 0), 1);
         DegreeConstraint dc(graph_, &range);
 
-        DdStructure<2> dd(dc);
+        DdStructure<2> dd(dc, use_mp_);
         ZBDD z = dd.evaluate(ToZBDD());
         if (z == ZBDD(-1)) {
             std::cerr << "Cannot construct the matching set ZDD due to memory shortage." << std::endl;
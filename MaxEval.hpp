@@ -26,6 +26,8 @@
 #include "tdzdd/util/IntSubset.hpp"
 #include "tdzdd/spec/DegreeConstraint.hpp"
 #include "tdzdd/eval/ToZBDD.hpp"
+#include "tdzdd/spec/SapporoZdd.hpp"
+#include "tdzdd/spec/SizeConstraint.hpp"
 
 class MaxEval : public tdzdd::DdEval<MaxEval, int> {
 private:
@@ -45,4 +47,37 @@ public:
 
 };
 
+class MinEval : public tdzdd::DdEval<MinEval, int> {
+public:
+
+    void evalTerminal(int& v, int id) const
+    {
+        v = (id == 1 ? 0 : INT_MAX);
+    }
+
+    void evalNode(int& v, int /*level*/, tdzdd::DdValues<int, 2> const& values)
+    {
+        int v1 = values.get(1);
+        v = std::min(values.get(0), (v1 == INT_MAX ? INT_MAX : v1 + 1));
+    }
+
+};
+
+// Return the family of the maximum-size sets in f, where f is a family
+// over {1,...,num_elements}. If use_mp is true, the DdStructure of the
+// size constraint is constructed in parallel. That of f is always
+// constructed sequentially since SapporoZdd reads the nodes of SAPPOROBDD,
+// which is not thread-safe.
+inline ZBDD getMaximumSets(const ZBDD& f, int num_elements,
+                           bool use_mp = false)
+{
+    tdzdd::SapporoZdd sz(f);
+    tdzdd::DdStructure<2> dds(sz);
+    int max_value = dds.evaluate(MaxEval());
+    tdzdd::IntRange at_least_k(max_value, num_elements);
+    tdzdd::SizeConstraint sc(num_elements, at_least_k);
+    tdzdd::DdStructure<2> ddm(sc, use_mp);
+    return f & ddm.evaluate(tdzdd::ToZBDD());
+}
+
 #endif // MAX_EVAL_HPP
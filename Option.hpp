@@ -33,25 +33,56 @@ public:
     bool show_info = true;
     bool rand_start = false;
     bool rand_max = false;
+    bool start_max = false;
+    bool start_file = false;
     bool is_enum = false;
     bool st_mode = false;
     bool stb_mode = false;
+    bool stb_balanced = false;
     bool stw_mode = false;
+    bool sts_mode = false;
+    int num_samples = 0;
     bool st_file = false;
+    bool t_file = false;
     bool zdd_dir = false;
+    bool is_checkpoint = false;
+    int checkpoint_interval = 0;
+    int num_procs = 1;
+    int num_threads = 1;
+    bool is_conj = false;
+    int conj_group_size = 0;
+    bool is_vorder = false;
+    bool is_eorder = false;
+    bool is_bf = false;
+    bool is_prune = false;
+    int prune_bound = 0;
+    bool is_stats = false;
+    int hybrid_threshold = 0;
     bool longest_mode = false;
     bool is_gc = false;
     bool is_rainbow = false;
     int tar_k = 0;
+    int tj_k = 1; // the number of tokens that jump at once
+    int tar_k_max = -1; // -1 means no upper bound
     std::string graph_filename;
     std::string st_filename;
+    std::string t_filename;
+    std::string start_filename;
+    std::string sts_prefix;
     std::string zdd_dirname;
+    std::string stats_filename;
 
     enum SolKind sol_kind = IND_SET;
     enum Model model = TJ;
 
 public:
 
+    // true if the search starts from a family of sets instead of s
+    bool isStartFamily() const
+    {
+        return start_max || start_file;
+    }
+
     bool isEdgeVariable() const
     {
         return sol_kind == MATCHING
@@ -84,6 +115,10 @@ public:
             } else if (std::string(argv[i]) == std::string("--stb")) {
                 st_mode = true;
                 stb_mode = true;
+            } else if (std::string(argv[i]) == std::string("--stbal")) {
+                st_mode = true;
+                stb_mode = true;
+                stb_balanced = true;
             } else if (std::string(argv[i]) == std::string("--stw")
                        || std::string(argv[i]) == std::string("--stwidth")) {
                 st_mode = true;
@@ -91,9 +126,81 @@ public:
             } else if (std::string(argv[i]).find(std::string("--stfile=")) == 0) {
                 st_file = true;
                 st_filename = std::string(argv[i]).substr(9);
+            } else if (std::string(argv[i]).find(std::string("--stsample=")) == 0) {
+                st_mode = true;
+                num_samples = atoi(std::string(argv[i]).substr(11).c_str());
+                if (num_samples < 1) {
+                    std::cerr << "The number of samples must be positive." << std::endl;
+                    exit(1);
+                }
+            } else if (std::string(argv[i]).find(std::string("--stspace=")) == 0) {
+                st_mode = true;
+                sts_mode = true;
+                sts_prefix = std::string(argv[i]).substr(10);
+            } else if (std::string(argv[i]) == std::string("--startmax")) {
+                start_max = true;
+            } else if (std::string(argv[i]).find(std::string("--startfile=")) == 0) {
+                start_file = true;
+                start_filename = std::string(argv[i]).substr(12);
+            } else if (std::string(argv[i]).find(std::string("--tfile=")) == 0) {
+                st_mode = true;
+                t_file = true;
+                t_filename = std::string(argv[i]).substr(8);
             } else if (std::string(argv[i]).find(std::string("--zdddir=")) == 0) {
                 zdd_dir = true;
                 zdd_dirname = std::string(argv[i]).substr(9);
+            } else if (std::string(argv[i]) == std::string("--bf")) {
+                is_bf = true;
+            } else if (std::string(argv[i]).find(std::string("--prune=")) == 0) {
+                is_prune = true;
+                prune_bound = atoi(std::string(argv[i]).substr(8).c_str());
+                if (prune_bound < 1) {
+                    std::cerr << "The bound of --prune must be positive." << std::endl;
+                    exit(1);
+                }
+            } else if (std::string(argv[i]).find(std::string("--procs=")) == 0) {
+                num_procs = atoi(std::string(argv[i]).substr(8).c_str());
+                if (num_procs < 1) {
+                    std::cerr << "The number of processes must be positive." << std::endl;
+                    exit(1);
+                }
+            } else if (std::string(argv[i]).find(std::string("--hybrid=")) == 0) {
+                hybrid_threshold = atoi(std::string(argv[i]).substr(9).c_str());
+                if (hybrid_threshold < 1) {
+                    std::cerr << "The threshold of --hybrid must be positive." << std::endl;
+                    exit(1);
+                }
+            } else if (std::string(argv[i]) == std::string("--stats")) {
+                is_stats = true;
+            } else if (std::string(argv[i]).find(std::string("--stats=")) == 0) {
+                is_stats = true;
+                stats_filename = std::string(argv[i]).substr(8);
+            } else if (std::string(argv[i]) == std::string("--conj")) {
+                is_conj = true;
+                conj_group_size = 0;
+            } else if (std::string(argv[i]).find(std::string("--conj=")) == 0) {
+                is_conj = true;
+                conj_group_size = atoi(std::string(argv[i]).substr(7).c_str());
+            } else if (std::string(argv[i]) == std::string("--vorder")) {
+                is_vorder = true;
+            } else if (std::string(argv[i]) == std::string("--eorder")) {
+                is_eorder = true;
+            } else if (std::string(argv[i]).find(std::string("--threads=")) == 0) {
+                num_threads = atoi(std::string(argv[i]).substr(10).c_str());
+                if (num_threads < 1) {
+                    std::cerr << "The number of threads must be positive." << std::endl;
+                    exit(1);
+                }
+            } else if (std::string(argv[i]) == std::string("--checkpoint")) {
+                is_checkpoint = true;
+                checkpoint_interval = 0;
+            } else if (std::string(argv[i]).find(std::string("--checkpoint=")) == 0) {
+                is_checkpoint = true;
+                checkpoint_interval = atoi(std::string(argv[i]).substr(13).c_str());
+                if (checkpoint_interval < 3) {
+                    std::cerr << "The checkpoint interval must be at least 3." << std::endl;
+                    exit(1);
+                }
             } else if (std::string(argv[i]) == std::string("--longest")) {
                 longest_mode = true;
             } else if (std::string(argv[i]) == std::string("--gc")) {
@@ -106,12 +213,40 @@ public:
             } else if (std::string(argv[i]) == std::string("--tj")
                        || std::string(argv[i]) == std::string("--tokenjump")) {
                 model = TJ;
+                tj_k = 1;
+            } else if (std::string(argv[i]).find(std::string("--tj=")) == 0) {
+                model = TJ;
+                tj_k = atoi(std::string(argv[i]).substr(5).c_str());
+                if (tj_k < 1) {
+                    std::cerr << "The number of jumping tokens must be positive." << std::endl;
+                    exit(1);
+                }
+                if (tj_k > RECONF_JUMP_MAXK) {
+                    std::cerr << "The number of jumping tokens must be at most "
+                              << RECONF_JUMP_MAXK << "." << std::endl;
+                    exit(1);
+                }
             } else if (std::string(argv[i]) == std::string("--ts")
                        || std::string(argv[i]) == std::string("--tokenslide")) {
                 model = TS;
             } else if (std::string(argv[i]).find(std::string("--tar=")) == 0) {
                 model = TAR;
-                tar_k = atoi(std::string(argv[i]).substr(6).c_str());
+                // --tar=<k>, --tar=<lo>:<hi>, --tar=:<hi> or --tar=<lo>:
+                std::string range = std::string(argv[i]).substr(6);
+                size_t pos = range.find(':');
+                if (pos == std::string::npos) {
+                    tar_k = atoi(range.c_str());
+                } else {
+                    tar_k = atoi(range.substr(0, pos).c_str());
+                    std::string hi = range.substr(pos + 1);
+                    // an empty <hi> means no upper bound
+                    tar_k_max = (hi.empty() ? -1 : atoi(hi.c_str()));
+                    if (tar_k_max >= 0 && tar_k_max < tar_k) {
+                        std::cerr << "The upper bound of --tar must be at least"
+                                  << " the lower bound." << std::endl;
+                        exit(1);
+                    }
+                }
             } else if (std::string(argv[i]) == std::string("--rainbow")) {
                 is_rainbow = true;
             } else if (std::string(argv[i]) == std::string("--indset")
@@ -178,6 +313,78 @@ public:
             std::cerr << "The input graph file must be specified." << std::endl;
             exit(1);
         }
+        if (is_bf && model == TS) {
+            std::cerr << "--bf cannot be used with --ts." << std::endl;
+            exit(1);
+        }
+        if (is_bf && model == TJ && tj_k >= 2) {
+            std::cerr << "--bf cannot be used with --tj=<k> for k >= 2."
+                      << std::endl;
+            exit(1);
+        }
+        if (num_samples > 0 && model == TJ && tj_k >= 2) {
+            std::cerr << "--stsample cannot be used with --tj=<k> for k >= 2."
+                      << std::endl;
+            exit(1);
+        }
+        if (is_prune) {
+            // Layers are pruned only in the search of --st from s to t.
+            if (!st_mode) {
+                std::cerr << "--prune must be used with --st." << std::endl;
+                exit(1);
+            }
+            std::string conflict;
+            if (stb_mode) {
+                conflict = "--stb/--stbal";
+            } else if (t_file) {
+                conflict = "--tfile";
+            } else if (isStartFamily()) {
+                conflict = "--startmax/--startfile";
+            } else if (stw_mode) {
+                conflict = "--stwidth";
+            } else if (sts_mode) {
+                conflict = "--stspace";
+            } else if (num_samples > 0) {
+                conflict = "--stsample";
+            } else if (hybrid_threshold > 0) {
+                conflict = "--hybrid";
+            }
+            if (!conflict.empty()) {
+                std::cerr << "--prune cannot be used with " << conflict
+                          << "." << std::endl;
+                exit(1);
+            }
+        }
+        if (isStartFamily()) {
+            // The start family replaces s (in the input or --stfile),
+            // so the options using s itself or other goals are rejected.
+            std::string conflict;
+            if (rand_start) {
+                conflict = "--randstart";
+            } else if (t_file) {
+                conflict = "--tfile";
+            } else if (stb_mode) {
+                conflict = "--stb/--stbal";
+            } else if (stw_mode) {
+                conflict = "--stwidth";
+            } else if (sts_mode) {
+                conflict = "--stspace";
+            } else if (num_samples > 0) {
+                conflict = "--stsample";
+            } else if (longest_mode) {
+                conflict = "--longest";
+            }
+            if (!conflict.empty()) {
+                std::cerr << "--startmax and --startfile cannot be used with "
+                          << conflict << "." << std::endl;
+                exit(1);
+            }
+            if (!st_mode) {
+                std::cerr << "--startmax and --startfile must be used with --st."
+                          << std::endl;
+                exit(1);
+            }
+        }
     }
 };
 
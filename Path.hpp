@@ -49,7 +49,7 @@ public:
 
         FrontierDegreeSpecifiedSpec spec(graph_, degRanges);
 
-        DdStructure<2> dd(spec);
+        DdStructure<2> dd(spec, use_mp_);
         ZBDD z = dd.evaluate(ToZBDD());
 
         for (size_t i = 0; i < degRanges.size(); ++i) {
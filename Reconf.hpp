@@ -24,11 +24,25 @@
 
 #include <vector>
 #include <list>
+#include <map>
 #include <algorithm>
 #include <random>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#ifndef _WIN32
+#include <unistd.h>
+#include <sys/wait.h>
+#endif
 #include "tdzdd/spec/SizeConstraint.hpp"
 
 #include "BigInteger.hpp"
+#include "SymmetricDifferenceSpec.hpp"
+#include "ExplicitLayer.hpp"
+#include "EdgeOrder.hpp"
+#include "CountFamily.hpp"
+#include "MaxEval.hpp"
 
 enum Mode {ST, LONGEST};
 
@@ -40,14 +54,93 @@ private:
     ZBDD solution_space_zdd_;
     std::vector<ZBDD> F_;
     std::vector<ZBDD> Fg_; // only used for the bidirection mode
+    // P_[i] is the family of the sets that are the i-th sets of
+    // some shortest reconfiguration sequence, and P_counts_[i] is
+    // the cardinality of P_[i]. Constructed by reconfigureShortestSpace().
+    std::vector<ZBDD> P_;
+    std::vector<BigInteger> P_counts_;
     BigIntegerRandom& random_;
     bool is_edge_variable_;
     bool is_zdd_store_;
     std::string zdd_dirname_;
+    // If is_checkpoint_ is true, reconfigure() keeps only the last two
+    // layers and the checkpoint layers in F_ (the others are replaced
+    // with the null ZDD), and backtrack() rebuilds the dropped layers.
+    bool is_checkpoint_;
+    // 0 means that the interval is adjusted to about sqrt(#steps).
+    int checkpoint_interval_;
+    int current_interval_;
     bool show_info_;
     bool show_info_verbose_;
     bool is_gc_;
+    // If true, reconfigureBoth() extends the side whose last layer has
+    // fewer ZDD nodes instead of extending both sides alternately.
+    bool is_balanced_;
+    // If num_procs_ >= 2, getNextStep() splits the current layer into
+    // num_procs_ shards and expands them in child processes.
+    int num_procs_;
+    // true if all the sets in solution_space_zdd_ have the same size,
+    // which is set by restrictToStartSize()
+    bool is_uniform_;
+    // If true, the level-synchronous operators (*_bf) are used for
+    // TJ and TAR, which do not recurse once per level.
+    bool is_breadth_first_;
+    // If is_prune_ is true, findReconfSeq() removes from the i-th layer
+    // the sets X whose lower bound of the distance from X to the goal
+    // set exceeds prune_bound_ - i.
+    bool is_prune_;
+    int prune_bound_;
+    bool is_pruning_; // true while the search with pruning is running
+    bool has_pruned_; // true if some set has been removed by pruning
+    std::set<bddvar> prune_goal_set_;
+    // the kind of the layer computed by getNextStep(): a layer of
+    // the search from s, of the search from t (bidirectional search),
+    // a layer rebuilt from a checkpoint, or a layer of a search with
+    // pruning that was run again without pruning
+    enum StepKind {STEP_FORWARD, STEP_BACKWARD, STEP_REBUILD, STEP_DISCARDED};
+    // statistics of each call of getNextStep() (for --stats)
+    struct StepStat {
+        int step;              // the index of the computed layer
+        StepKind kind;
+        double neighbor_time;  // time for the neighbors of the layer & S
+        double subtract_time;  // time for removing the previous layers
+        double prune_time;     // time for pruneLayer()
+        size_t num_nodes;      // # ZDD nodes of the resulting layer
+        unsigned long long calls;   // the totals of the counters of
+        unsigned long long lookups; // bddc_reconf.c during the step
+        unsigned long long hits;
+        unsigned long long nodes;
+    };
+    bool is_stats_;
+    std::vector<StepStat> step_stats_;
+    // the maximum number of tokens that jump at once in TJ (--tj=<k>)
+    int jump_k_;
+    // If hybrid_threshold_ > 0, reconfigure() stores the layers explicitly
+    // while they have at most hybrid_threshold_ sets.
+    int hybrid_threshold_;
+    // explicit_layers_[i] is the i-th layer of the last search
+    // for 0 <= i < explicit_layers_.size()
+    std::vector<ExplicitLayer> explicit_layers_;
     Graph graph_;
+    // edge_numbers_[j]: the edge number in the input of the edge j of
+    // graph_ if the edges are reordered (--eorder), and empty otherwise
+    std::vector<int> edge_numbers_;
+    // input_var_map_[v]: the variable of the input numbering for the
+    // variable v if the variables are reordered (--vorder or --eorder),
+    // and empty otherwise. The files of --stspace are written with it.
+    std::vector<bddvar> input_var_map_;
+    // for the token sliding model
+    // ts_elements_: all the variables in the descending order of their levels
+    // ts_adjacent_lists_[v]: the variables adjacent to variable v
+    //                        in the same order
+    // Both are terminated by -1 so that they can be passed to
+    // swap_adjacent_element.
+    std::vector<int> ts_elements_;
+    std::vector<std::vector<int> > ts_adjacent_lists_;
+    std::vector<int*> ts_adjacent_;
+    // copies of ts_elements_ and ts_adjacent_ owned by bddc_reconf.c
+    int* ts_interned_elements_;
+    int** ts_interned_adjacent_;
 
 public:
     Reconf(BigIntegerRandom& random, int num_elements,
@@ -57,8 +150,15 @@ public:
           model_(TJ),
           random_(random),
           is_edge_variable_(is_edge_variable), is_zdd_store_(false),
+          is_checkpoint_(false), checkpoint_interval_(0),
+          current_interval_(0),
           show_info_(show_info),
-          show_info_verbose_(false), is_gc_(is_gc), graph_(graph) {}
+          show_info_verbose_(false), is_gc_(is_gc), is_balanced_(false),
+          num_procs_(1), is_uniform_(false),
+          is_breadth_first_(false), is_prune_(false), prune_bound_(0),
+          is_pruning_(false), has_pruned_(false), is_stats_(false),
+          jump_k_(1), hybrid_threshold_(0), graph_(graph),
+          ts_interned_elements_(NULL), ts_interned_adjacent_(NULL) {}
 
     void setNumElements(int num_elements)
     {
@@ -70,73 +170,389 @@ public:
         solution_space_zdd_ = solution_space_zdd;
     }
 
-    void setSolutionSpaceZddTar(const ZBDD& solution_space_zdd, int k)
+    // Restrict the solution space to the sets X with k <= |X| <= k_max.
+    // k_max < 0 means that there is no upper bound.
+    void setSolutionSpaceZddTar(const ZBDD& solution_space_zdd, int k,
+                                int k_max = -1)
     {
-        IntRange at_least_k(k, num_elements_);
+        IntRange at_least_k(k, (k_max >= 0 ? k_max : num_elements_));
         SizeConstraint sc(num_elements_, at_least_k);
         DdStructure<2> dd(sc);
         ZBDD sczdd = dd.evaluate(ToZBDD());
         solution_space_zdd_ = solution_space_zdd & sczdd;
     }
 
+    // TJ and TS do not change the number of tokens, so the sets whose
+    // sizes differ from those of the start sets are never reached.
+    // Remove them from the solution space.
+    void restrictToStartSize(const ZBDD& start_zdd)
+    {
+        if (model_ == TAR) {
+            return;
+        }
+        SapporoZdd sz(start_zdd);
+        DdStructure<2> dd(sz);
+        int min_size = dd.evaluate(MinEval());
+        int max_size = dd.evaluate(MaxEval());
+        IntRange size_range(min_size, max_size);
+        SizeConstraint sc(num_elements_, size_range);
+        DdStructure<2> dds(sc);
+        ZBDD sliced_zdd = solution_space_zdd_ & dds.evaluate(ToZBDD());
+        if (show_info_) {
+            std::cerr << "Solution space restricted to " << min_size
+                      << " <= |X| <= " << max_size << ": # ZDD nodes "
+                      << solution_space_zdd_.Size() << " -> "
+                      << sliced_zdd.Size() << std::endl;
+        }
+        solution_space_zdd_ = sliced_zdd;
+        is_uniform_ = (min_size == max_size);
+    }
+
     void setModelTar()
     {
         model_ = TAR;
     }
 
+    // In TJ, up to k tokens jump at once in one step.
+    void setJumpSize(int k)
+    {
+        jump_k_ = k;
+    }
+
+    void setModelTs()
+    {
+        model_ = TS;
+        constructAdjacency();
+    }
+
+    // Construct ts_elements_ and ts_adjacent_lists_ from graph_.
+    // For vertex variables, two variables are adjacent if the
+    // corresponding vertices are adjacent. For edge variables,
+    // two variables are adjacent if the corresponding edges
+    // share an endpoint.
+    void constructAdjacency()
+    {
+        const int m = graph_.edgeSize();
+        std::vector<std::set<int> > adjacent_sets(num_elements_ + 1);
+
+        if (is_edge_variable_) {
+            // incident_edges[v] stores the variables of edges incident to v
+            std::vector<std::vector<int> > incident_edges(graph_.vertexSize() + 1);
+            for (int i = 0; i < m; ++i) {
+                const Graph::EdgeInfo& edge = graph_.edgeInfo(i);
+                // The variable of the i-th edge is m - i.
+                incident_edges[edge.v1].push_back(m - i);
+                incident_edges[edge.v2].push_back(m - i);
+            }
+            for (size_t v = 1; v < incident_edges.size(); ++v) {
+                const std::vector<int>& es = incident_edges[v];
+                for (size_t j = 0; j < es.size(); ++j) {
+                    for (size_t k = 0; k < es.size(); ++k) {
+                        if (es[j] != es[k]) {
+                            adjacent_sets[es[j]].insert(es[k]);
+                        }
+                    }
+                }
+            }
+        } else {
+            for (int i = 0; i < m; ++i) {
+                const Graph::EdgeInfo& edge = graph_.edgeInfo(i);
+                if (edge.v1 <= num_elements_ && edge.v2 <= num_elements_) {
+                    adjacent_sets[edge.v1].insert(edge.v2);
+                    adjacent_sets[edge.v2].insert(edge.v1);
+                }
+            }
+        }
+
+        ts_elements_.clear();
+        for (int v = 1; v <= num_elements_; ++v) {
+            ts_elements_.push_back(v);
+        }
+        std::sort(ts_elements_.begin(), ts_elements_.end(), LevelGreater());
+        ts_elements_.push_back(-1);
+
+        ts_adjacent_lists_.assign(num_elements_ + 1, std::vector<int>());
+        ts_adjacent_.assign(num_elements_ + 1, NULL);
+        for (int v = 0; v <= num_elements_; ++v) {
+            std::vector<int>& list = ts_adjacent_lists_[v];
+            list.assign(adjacent_sets[v].begin(), adjacent_sets[v].end());
+            std::sort(list.begin(), list.end(), LevelGreater());
+            list.push_back(-1);
+            ts_adjacent_[v] = &list[0];
+        }
+        // Intern the arrays so that swap_adjacent_element can use
+        // the operation cache. If it fails, use the arrays as they are.
+        if (reconf_intern_adjacent(&ts_elements_[0], &ts_adjacent_[0],
+                                   static_cast<int>(ts_adjacent_.size()),
+                                   &ts_interned_elements_,
+                                   &ts_interned_adjacent_) != 0) {
+            ts_interned_elements_ = &ts_elements_[0];
+            ts_interned_adjacent_ = &ts_adjacent_[0];
+        }
+    }
+
+    struct LevelGreater {
+        bool operator()(int v1, int v2) const
+        {
+            return BDD_LevOfVar(v1) > BDD_LevOfVar(v2);
+        }
+    };
+
     void setZddDir(const std::string& zdd_dirname)
     {
         is_zdd_store_ = true;
         zdd_dirname_ = zdd_dirname;
     }
 
+    void setBalancedBidirection()
+    {
+        is_balanced_ = true;
+    }
+
+    // bound: an upper bound on the number of steps of
+    //        a shortest reconfiguration sequence
+    void setPruning(int bound)
+    {
+        is_prune_ = true;
+        prune_bound_ = bound;
+    }
+
+    void setBreadthFirst()
+    {
+        is_breadth_first_ = true;
+    }
+
+    void setNumProcs(int num_procs)
+    {
+#ifdef _WIN32
+        if (num_procs >= 2) {
+            std::cerr << "Multi-process expansion is not supported "
+                      << "on this platform." << std::endl;
+        }
+#else
+        num_procs_ = num_procs;
+#endif
+    }
+
+    // The edges of graph_ are reordered and edge_numbers[j] is
+    // the edge number in the input of the edge j.
+    void setEdgeNumbers(const std::vector<int>& edge_numbers)
+    {
+        edge_numbers_ = edge_numbers;
+    }
+
+    // The variables are reordered and input_var_map[v] is the variable
+    // of the input numbering for the variable v.
+    void setInputVariableMap(const std::vector<bddvar>& input_var_map)
+    {
+        input_var_map_ = input_var_map;
+    }
+
+    // The layers of the search from s (--st) are stored explicitly
+    // while they have at most threshold sets.
+    void setHybrid(int threshold)
+    {
+        hybrid_threshold_ = threshold;
+    }
+
+    // Record the statistics of the operators and of each step.
+    void setStats()
+    {
+        is_stats_ = true;
+        reconf_clear_stats();
+    }
+
+    // Output the totals of the counters of the operators in bddc_reconf.c
+    // and of the times of the phases of the steps. The counters of the
+    // child processes of --procs are not included.
+    void printStats(std::ostream& ost) const
+    {
+        ost << "operator                  calls      lookups         hits"
+            << "        nodes  hit rate" << std::endl;
+        for (int i = 0; i < RECONF_NUM_STATS; ++i) {
+            struct reconf_stat stat;
+            reconf_get_stat(i, &stat);
+            if (stat.calls == 0) {
+                continue;
+            }
+            ost << std::left << std::setw(24) << reconf_stat_name(i)
+                << std::right
+                << std::setw(8) << stat.calls
+                << std::setw(13) << stat.lookups
+                << std::setw(13) << stat.hits
+                << std::setw(13) << stat.nodes << "  ";
+            if (stat.lookups > 0) {
+                ost << std::fixed << std::setprecision(3)
+                    << static_cast<double>(stat.hits) / stat.lookups;
+                ost.unsetf(std::ios::fixed);
+                ost << std::setprecision(6);
+            } else {
+                ost << "-";
+            }
+            ost << std::endl;
+        }
+        double neighbor_time = 0.0;
+        double subtract_time = 0.0;
+        double prune_time = 0.0;
+        for (size_t i = 0; i < step_stats_.size(); ++i) {
+            neighbor_time += step_stats_[i].neighbor_time;
+            subtract_time += step_stats_[i].subtract_time;
+            prune_time += step_stats_[i].prune_time;
+        }
+        ost << "# layer computations = " << step_stats_.size()
+            << ", neighbors time = " << neighbor_time
+            << ", subtraction time = " << subtract_time
+            << ", pruning time = " << prune_time << std::endl;
+    }
+
+    // Write a row for each step into the file filename.
+    void writeStepStats(const std::string& filename) const
+    {
+        std::ofstream ofs(filename.c_str());
+        if (!ofs) {
+            std::cerr << "File " << filename << " cannot be opened."
+                      << std::endl;
+            exit(6);
+        }
+        static const char* const kind_names[] = {"forward", "backward",
+                                                 "rebuild", "discarded"};
+        ofs << "# step kind neighbor_time subtract_time prune_time"
+            << " zdd_nodes calls lookups hits nodes" << std::endl;
+        for (size_t i = 0; i < step_stats_.size(); ++i) {
+            const StepStat& st = step_stats_[i];
+            ofs << st.step << " " << kind_names[st.kind] << " "
+                << st.neighbor_time << " "
+                << st.subtract_time << " " << st.prune_time << " "
+                << st.num_nodes << " " << st.calls << " " << st.lookups
+                << " " << st.hits << " " << st.nodes << std::endl;
+        }
+    }
+
+    // Layers F_[c - 1] and F_[c] are kept for every multiple c of
+    // interval. If interval is 0, the interval is doubled whenever
+    // the number of steps exceeds its square.
+    void setCheckpoint(int interval)
+    {
+        is_checkpoint_ = true;
+        checkpoint_interval_ = interval;
+    }
+
     void findReconfSeq(const std::set<bddvar>& start_set,
                        const std::set<bddvar>& goal_set)
     {
         mode_ = ST;
         F_.clear();
+        is_pruning_ = is_prune_;
+        has_pruned_ = false;
+        prune_goal_set_ = goal_set;
         int step = reconfigure(start_set, goal_set);
+        if (step < 0 && is_pruning_ && has_pruned_) {
+            // The bound was smaller than the distance from s to t.
+            if (show_info_) {
+                std::cerr << "t not found within " << prune_bound_
+                          << " steps, search again without pruning"
+                          << std::endl;
+            }
+            is_pruning_ = false;
+            F_.clear();
+            for (size_t i = 0; i < step_stats_.size(); ++i) {
+                step_stats_[i].kind = STEP_DISCARDED;
+            }
+            step = reconfigure(start_set, goal_set);
+        }
         if (step < 0) {
             std::cout << "a NO" << std::endl;
         } else {
             std::cout << "a YES" << std::endl;
             std::list<std::set<bddvar> > sequence;
-            backtrack(start_set, goal_set, F_, &sequence);
+            backtrack(goal_set, F_, &sequence, &explicit_layers_);
             outputSequence(sequence, std::cout);
         }
     }
 
-    void findReconfSeqBoth(const std::set<bddvar>& start_set,
-                           const std::set<bddvar>& goal_set)
+    // Search a reconfiguration sequence from any set in start_zdd
+    // to goal_set. The start set of the found sequence is output
+    // in the line "c source".
+    void findReconfSeqFromFamily(const ZBDD& start_zdd,
+                                 const std::set<bddvar>& goal_set)
     {
         mode_ = ST;
         F_.clear();
-        int step = reconfigureBoth(start_set, goal_set);
+        int step = reconfigure(start_zdd, goal_set);
         if (step < 0) {
             std::cout << "a NO" << std::endl;
         } else {
             std::cout << "a YES" << std::endl;
-            if (step >= 2) {
-                std::set<bddvar> middle_set = pickRandomly(F_.back() & Fg_.back(), random_);
-                std::list<std::set<bddvar> > first_sequence;
-                backtrack(start_set, middle_set, F_, &first_sequence);
-                std::list<std::set<bddvar> > second_sequence;
-                backtrack(goal_set, middle_set, Fg_, &second_sequence);
-                std::list<std::set<bddvar> >::const_reverse_iterator itor;
-                itor = second_sequence.rbegin();
-                ++itor; // ignore the first element
-                for ( ; itor != second_sequence.rend(); ++itor) {
-                    first_sequence.push_back(*itor);
-                }
-                outputSequence(first_sequence, std::cout);
+            std::list<std::set<bddvar> > sequence;
+            backtrack(goal_set, F_, &sequence, &explicit_layers_);
+            std::cout << "c source ";
+            if (is_edge_variable_) {
+                printSet(std::cout,
+                         restoreEdgeSet(inverseSet(sequence.front(),
+                                                   num_elements_ + 1),
+                                        edge_numbers_),
+                         graph_, is_edge_variable_);
+            } else {
+                printSet(std::cout, sequence.front(), graph_,
+                         is_edge_variable_);
+            }
+            outputSequence(sequence, std::cout);
+        }
+    }
+
+    // For each goal set, output "c target <i>" followed by
+    // the answer for it. All the goal sets share one search from start_set.
+    void findReconfSeqMulti(const std::set<bddvar>& start_set,
+                            const std::vector<std::set<bddvar> >& goal_sets)
+    {
+        mode_ = ST;
+        F_.clear();
+        std::vector<int> steps;
+        reconfigureMulti(start_set, goal_sets, &steps);
+        for (size_t j = 0; j < goal_sets.size(); ++j) {
+            std::cout << "c target " << (j + 1) << std::endl;
+            if (steps[j] < 0) {
+                std::cout << "a NO" << std::endl;
             } else {
+                std::cout << "a YES" << std::endl;
+                // backtrack() erases the layers, so it works on a copy.
+                std::vector<ZBDD> zdd_sequence(F_.begin(),
+                                               F_.begin() + steps[j] + 1);
                 std::list<std::set<bddvar> > sequence;
-                backtrack(start_set, goal_set, F_, &sequence);
+                backtrack(goal_sets[j], zdd_sequence, &sequence);
                 outputSequence(sequence, std::cout);
             }
         }
     }
 
+    void findReconfSeqBoth(const std::set<bddvar>& start_set,
+                           const std::set<bddvar>& goal_set)
+    {
+        mode_ = ST;
+        F_.clear();
+        Fg_.clear();
+        int step = reconfigureBoth(start_set, goal_set);
+        if (step < 0) {
+            std::cout << "a NO" << std::endl;
+        } else {
+            std::cout << "a YES" << std::endl;
+            // The numbers of layers of F_ and Fg_ may differ.
+            // If one of them consists only of s (or t), middle_set is s (or t).
+            std::set<bddvar> middle_set = pickRandomly(F_.back() & Fg_.back(), random_);
+            std::list<std::set<bddvar> > first_sequence;
+            backtrack(middle_set, F_, &first_sequence);
+            std::list<std::set<bddvar> > second_sequence;
+            backtrack(middle_set, Fg_, &second_sequence);
+            std::list<std::set<bddvar> >::const_reverse_iterator itor;
+            itor = second_sequence.rbegin();
+            ++itor; // ignore the first element
+            for ( ; itor != second_sequence.rend(); ++itor) {
+                first_sequence.push_back(*itor);
+            }
+            outputSequence(first_sequence, std::cout);
+        }
+    }
+
     void findReconfSeqAndWidth(const std::set<bddvar>& start_set,
                                const std::set<bddvar>& goal_set)
     {
@@ -148,11 +564,146 @@ public:
         } else {
             std::cout << "a YES" << std::endl;
             std::list<std::set<bddvar> > sequence;
-            backtrack(start_set, goal_set, F_, &sequence);
+            backtrack(goal_set, F_, &sequence);
+            outputSequence(sequence, std::cout);
+        }
+    }
+
+    // Compute the sets on shortest reconfiguration sequences from
+    // start_set to goal_set. The number of such sets for each step i
+    // is output, and they are stored as a ZDD into file <prefix>i
+    // in the variable numbering of the input.
+    void findShortestSpace(const std::set<bddvar>& start_set,
+                           const std::set<bddvar>& goal_set,
+                           const std::string& prefix)
+    {
+        mode_ = ST;
+        F_.clear();
+        Fg_.clear();
+        int step = reconfigureShortestSpace(start_set, goal_set);
+        if (step < 0) {
+            std::cout << "a NO" << std::endl;
+            return;
+        }
+        std::cout << "a YES" << std::endl;
+        BigInteger total(0);
+        for (int i = 0; i <= step; ++i) {
+            std::cout << "c step " << i << " " << P_counts_[i] << std::endl;
+            total += P_counts_[i];
+            std::stringstream ss;
+            ss << prefix << i;
+            FILE* fp = fopen(ss.str().c_str(), "w");
+            if (fp == NULL) {
+                std::cerr << "File cannot be opened" << std::endl;
+                exit(6);
+            }
+            if (input_var_map_.empty()) {
+                P_[i].Export(fp);
+            } else {
+                permuteVariables(P_[i], input_var_map_).Export(fp);
+            }
+            fclose(fp);
+        }
+        std::cout << "c total " << total << std::endl;
+    }
+
+    // Output num_samples shortest reconfiguration sequences from
+    // start_set to goal_set, each of which is chosen uniformly at random
+    // from all the shortest reconfiguration sequences.
+    void findUniformShortestSeqs(const std::set<bddvar>& start_set,
+                                 const std::set<bddvar>& goal_set,
+                                 int num_samples)
+    {
+        mode_ = ST;
+        F_.clear();
+        Fg_.clear();
+        int step = reconfigureShortestSpace(start_set, goal_set);
+        if (step < 0) {
+            std::cout << "a NO" << std::endl;
+            return;
+        }
+        // path_counts[i] has, as the count of X in P_[i], the number of
+        // shortest sequences from start_set to X.
+        std::vector<CountFamily> path_counts(step + 1);
+        path_counts[0].push_back(getSingleSet(start_set));
+        for (int i = 1; i <= step; ++i) {
+            path_counts[i] = getNeighborCounts(path_counts[i - 1], P_[i]);
+            if (show_info_) {
+                std::cerr << "Counted the sequences to step " << i
+                          << " (" << path_counts[i].size() << " digits)"
+                          << std::endl;
+            }
+        }
+        std::cout << "a YES" << std::endl;
+        std::cout << "c # of shortest sequences = "
+                  << getCount(path_counts[step], goal_set) << std::endl;
+
+        for (int sample = 0; sample < num_samples; ++sample) {
+            std::list<std::set<bddvar> > sequence;
+            std::set<bddvar> current_set = goal_set;
+            sequence.push_front(current_set);
+            for (int i = step; i >= 1; --i) {
+                // choose a predecessor with probability proportional to
+                // the number of sequences through it
+                ZBDD predecessors = getNeighborsAnd(getSingleSet(current_set),
+                                                    P_[i - 1]);
+                current_set = sampleCountFamily(
+                    restrictCountFamily(path_counts[i - 1], predecessors),
+                    random_);
+                sequence.push_front(current_set);
+            }
+            std::cout << "c sample " << (sample + 1) << std::endl;
             outputSequence(sequence, std::cout);
         }
     }
 
+    // Return the count family whose count of X in g is the sum of
+    // the counts in c of the neighbors of X. Since the transformations
+    // below are bijections between families, they are applied digitwise.
+    // For TJ, the sets X - w + u (u != w) are obtained by removing u and
+    // adding w; u == w gives X itself, which c does not count because
+    // the sets of c are in the previous layer.
+    CountFamily getNeighborCounts(const CountFamily& c, const ZBDD& g)
+    {
+        CountFamily result;
+        if (model_ == TS) {
+            for (size_t j = 0; ts_elements_[j] >= 0; ++j) {
+                int u = ts_elements_[j];
+                const std::vector<int>& list = ts_adjacent_lists_[u];
+                for (size_t k = 0; list[k] >= 0; ++k) {
+                    int w = list[k];
+                    CountFamily term;
+                    for (size_t i = 0; i < c.size(); ++i) {
+                        term.push_back(c[i].OnSet0(u).OffSet(w).Change(w) & g);
+                    }
+                    addCountFamily(&result, term);
+                }
+            }
+            return result;
+        }
+        CountFamily removed;
+        ZBDD h = (model_ == TAR ? g : removeElement(g));
+        for (int u = 1; u <= num_elements_; ++u) {
+            CountFamily term;
+            for (size_t i = 0; i < c.size(); ++i) {
+                term.push_back(c[i].OnSet0(u) & h);
+            }
+            addCountFamily(&removed, term);
+        }
+        if (model_ == TAR) {
+            result = removed;
+        }
+        const CountFamily& base = (model_ == TAR ? c : removed);
+        for (int w = 1; w <= num_elements_; ++w) {
+            CountFamily term;
+            for (size_t i = 0; i < base.size(); ++i) {
+                term.push_back(base[i].OffSet(w).Change(w) & g);
+            }
+            addCountFamily(&result, term);
+        }
+        return result;
+    }
+
     void findReconfLongestSeq(const std::set<bddvar>& start_set)
     {
         mode_ = LONGEST;
@@ -160,9 +711,11 @@ public:
         // The second argument is empty because it is not used
         // when computing the longest sequence
         int step = reconfigure(start_set, std::set<bddvar>());
+        // remove the last layer, which is empty
+        F_.resize(step + 1);
         std::set<bddvar> goal_set = pickRandomly(F_[step], random_);
         std::list<std::set<bddvar> > sequence;
-        backtrack(start_set, goal_set, F_, &sequence);
+        backtrack(goal_set, F_, &sequence);
         outputSequence(sequence, std::cout);
     }
 
@@ -176,52 +729,48 @@ public:
             std::cerr << "The start set is not in the solution space." << std::endl;
             exit(2);
         }
+        return reconfigure(getSingleSet(start_set), goal_set);
+    }
+
+    // The same as above except that the search starts from
+    // all the sets in start_zdd.
+    int reconfigure(const ZBDD& start_zdd,
+                    const std::set<bddvar>& goal_set)
+    {
+        if ((start_zdd - solution_space_zdd_) != ZBDD(0)) {
+            std::cerr << "Some start set is not in the solution space." << std::endl;
+            exit(2);
+        }
         if (mode_ == ST) {
             if (!isMemberZ(solution_space_zdd_, goal_set)) {
                 std::cerr << "The goal set is not in the solution space." << std::endl;
                 exit(3);
             }
         }
-        ZBDD start_zdd = getSingleSet(start_set);
+        restrictToStartSize(start_zdd);
         F_.push_back(start_zdd);
+        explicit_layers_.clear();
 
-        if (start_set == goal_set) {
+        if (isMemberZ(start_zdd, goal_set)) {
             return 0;
         }
 
-        ZBDD zbdd_null = ZBDD(-1);
         ZBDD zbdd_empty = ZBDD(0);
-        int step;
-        for (step = 1; ; ++step) {
+        current_interval_ = (checkpoint_interval_ > 0 ? checkpoint_interval_ : 4);
+        int step = 1;
+        if (hybrid_threshold_ > 0 && mode_ == ST && jump_k_ == 1) {
+            if (reconfigureExplicit(goal_set, &step)) {
+                return step;
+            }
+            ++step;
+        }
+        for ( ; ; ++step) {
             if (show_info_) {
                 std::cerr << "Step " << step << " ";
             }
-            ZBDD previous_zdd = ZBDD(0); // empty zdd
-            if (step >= 2) {
-                previous_zdd = F_[step - 2];
-            }
-
-            ZBDD next_zdd = getNextStep(F_[step - 1], previous_zdd);
+            ZBDD next_zdd = computeLayer(F_, step, STEP_FORWARD);
             F_.push_back(next_zdd);
-
-            if (is_zdd_store_) {
-                if (step >= 1002 && step % 1000 == 2) {
-                    for (int j = step - 1000 - 1; j < step - 1; ++j) {
-                        std::stringstream ss;
-                        ss << zdd_dirname_ << j;
-                        FILE* fp = fopen(ss.str().c_str(), "w");
-                        if (fp == NULL) {
-                            std::cerr << "File cannot be opened" << std::endl;
-                            exit(6);
-                        }
-                        F_[j].Export(fp);
-                        fclose(fp);
-                        //std::cout << "erased " << j << " " << F_[j].Size() << std::endl;
-                        F_[j] = zbdd_null;
-                    }
-                    BDD_GC();
-                }
-            }
+            releaseLayers(F_, step);
 
             if (mode_ == ST) {
                 // check whether goal_set is in next_zdd
@@ -242,38 +791,547 @@ public:
                     return step - 1;
                 }
             }
-            if (!is_zdd_store_ && is_gc_ && step % 1000 == 0) {
+            if (is_gc_ && step % 1000 == 0) {
                 BDD_GC();
             }
         }
         // never come here
     }
 
-    ZBDD getNextStep(const ZBDD& current_zdd, const ZBDD& previous_zdd)
+    // (*steps)[j] is set to the number of steps from start_set to
+    // goal_sets[j], or -1 if goal_sets[j] is not reachable.
+    // The search stops when all the goal sets are found.
+    void reconfigureMulti(const std::set<bddvar>& start_set,
+                          const std::vector<std::set<bddvar> >& goal_sets,
+                          std::vector<int>* steps)
     {
-        double start_time = getTime();
-        double total_start_time = start_time;
-        ZBDD next_zdd;
+        assert(mode_ == ST);
+
+        if (!isMemberZ(solution_space_zdd_, start_set)) {
+            std::cerr << "The start set is not in the solution space." << std::endl;
+            exit(2);
+        }
+        steps->assign(goal_sets.size(), -1);
+        // indices of the goal sets that are not found yet
+        std::vector<size_t> pending;
+        for (size_t j = 0; j < goal_sets.size(); ++j) {
+            if (!isMemberZ(solution_space_zdd_, goal_sets[j])) {
+                std::cerr << "The goal set " << (j + 1)
+                          << " is not in the solution space." << std::endl;
+                exit(3);
+            } else if (goal_sets[j] == start_set) {
+                (*steps)[j] = 0;
+            } else {
+                pending.push_back(j);
+            }
+        }
+        restrictToStartSize(getSingleSet(start_set));
+        F_.push_back(getSingleSet(start_set));
+
+        ZBDD zbdd_empty = ZBDD(0);
+        current_interval_ = (checkpoint_interval_ > 0 ? checkpoint_interval_ : 4);
+        for (int step = 1; !pending.empty(); ++step) {
+            if (show_info_) {
+                std::cerr << "Step " << step << " ";
+            }
+            ZBDD next_zdd = computeLayer(F_, step, STEP_FORWARD);
+            F_.push_back(next_zdd);
+            releaseLayers(F_, step);
+
+            if (next_zdd == zbdd_empty) {
+                break;
+            }
+            std::vector<size_t> still_pending;
+            for (size_t k = 0; k < pending.size(); ++k) {
+                if (isMemberZ(next_zdd, goal_sets[pending[k]])) {
+                    (*steps)[pending[k]] = step;
+                } else {
+                    still_pending.push_back(pending[k]);
+                }
+            }
+            if (show_info_ && still_pending.size() < pending.size()) {
+                std::cerr << (pending.size() - still_pending.size())
+                          << " t found, " << still_pending.size()
+                          << " t remaining" << std::endl;
+            }
+            pending.swap(still_pending);
+
+            if (is_gc_ && step % 1000 == 0) {
+                BDD_GC();
+            }
+        }
+    }
+
+    // Search with the layers stored explicitly in explicit_layers_,
+    // where F_[0] is the family of the start sets. Return true if the
+    // search finishes, and then *step is the value to be returned by
+    // reconfigure(). Return false if a layer has more than
+    // hybrid_threshold_ sets, and then the layers are converted into
+    // F_[1], ..., F_[*step] so that the search continues with ZDDs.
+    // Pruning (--prune) is not applied to the explicit layers.
+    bool reconfigureExplicit(const std::set<bddvar>& goal_set, int* step)
+    {
+        *step = 0;
+        if (F_[0].Card() > static_cast<bddp>(hybrid_threshold_)) {
+            return false;
+        }
+        std::vector<std::set<bddvar> > start_sets;
+        getAllSets(F_[0], &start_sets);
+        explicit_layers_.push_back(ExplicitLayer());
+        for (size_t i = 0; i < start_sets.size(); ++i) {
+            explicit_layers_[0].insert(PackedSet(num_elements_,
+                                                 start_sets[i]));
+        }
+        const PackedSet goal(num_elements_, goal_set);
+        std::vector<PackedSet> neighbors;
+
+        for (int k = 1; ; ++k) {
+            if (show_info_) {
+                std::cerr << "Step " << k << " ";
+            }
+            double start_time = getTime();
+            ExplicitLayer next_layer;
+            const ExplicitLayer& current_layer = explicit_layers_[k - 1];
+            for (ExplicitLayer::const_iterator itor = current_layer.begin();
+                 itor != current_layer.end(); ++itor) {
+                neighbors.clear();
+                getExplicitNeighbors(*itor, &neighbors);
+                for (size_t j = 0; j < neighbors.size(); ++j) {
+                    const PackedSet& y = neighbors[j];
+                    if (current_layer.count(y) > 0
+                        || (k >= 2 && explicit_layers_[k - 2].count(y) > 0)
+                        || next_layer.count(y) > 0) {
+                        continue;
+                    }
+                    if (isMemberZ(solution_space_zdd_, y.toSet())) {
+                        next_layer.insert(y);
+                    }
+                }
+            }
+            if (show_info_) {
+                std::cerr << "time = " << (getTime() - start_time)
+                          << ", # elems = " << next_layer.size()
+                          << " (explicit)" << std::endl;
+            }
+            explicit_layers_.push_back(ExplicitLayer());
+            explicit_layers_.back().swap(next_layer);
+            F_.push_back(ZBDD(-1));
+            *step = k;
+
+            const ExplicitLayer& layer = explicit_layers_.back();
+            if (layer.count(goal) > 0) {
+                if (show_info_) {
+                    std::cerr << "t found" << std::endl;
+                }
+                return true;
+            }
+            if (layer.empty()) {
+                *step = -1;
+                return true;
+            }
+            if (layer.size() > static_cast<size_t>(hybrid_threshold_)) {
+                if (show_info_) {
+                    std::cerr << "Switch to ZDD layers" << std::endl;
+                }
+                for (int i = 1; i <= k; ++i) {
+                    F_[i] = getExplicitLayerZdd(explicit_layers_[i]);
+                }
+                return false;
+            }
+        }
+        // never come here
+    }
+
+    // Store into *neighbors all the sets obtained from x by one step
+    // of the model, whether they are in the solution space or not.
+    void getExplicitNeighbors(const PackedSet& x,
+                              std::vector<PackedSet>* neighbors) const
+    {
+        std::vector<int> in_x;
+        std::vector<int> out_x;
+        for (int v = 1; v <= num_elements_; ++v) {
+            if (x.test(v)) {
+                in_x.push_back(v);
+            } else {
+                out_x.push_back(v);
+            }
+        }
         if (model_ == TJ) {
-            next_zdd = swapElement(current_zdd, num_elements_);
+            for (size_t i = 0; i < in_x.size(); ++i) {
+                for (size_t j = 0; j < out_x.size(); ++j) {
+                    PackedSet y = x;
+                    y.reset(in_x[i]);
+                    y.set(out_x[j]);
+                    neighbors->push_back(y);
+                }
+            }
+        } else if (model_ == TS) {
+            for (size_t i = 0; i < in_x.size(); ++i) {
+                const std::vector<int>& adj = ts_adjacent_lists_[in_x[i]];
+                for (size_t j = 0; adj[j] >= 0; ++j) {
+                    if (!x.test(adj[j])) {
+                        PackedSet y = x;
+                        y.reset(in_x[i]);
+                        y.set(adj[j]);
+                        neighbors->push_back(y);
+                    }
+                }
+            }
+        } else { // model_ == TAR
+            for (size_t i = 0; i < in_x.size(); ++i) {
+                PackedSet y = x;
+                y.reset(in_x[i]);
+                neighbors->push_back(y);
+            }
+            for (size_t j = 0; j < out_x.size(); ++j) {
+                PackedSet y = x;
+                y.set(out_x[j]);
+                neighbors->push_back(y);
+            }
+        }
+    }
+
+    ZBDD getExplicitLayerZdd(const ExplicitLayer& layer) const
+    {
+        ZBDD f = ZBDD(0);
+        for (ExplicitLayer::const_iterator itor = layer.begin();
+             itor != layer.end(); ++itor) {
+            f += getSingleSet(itor->toSet());
+        }
+        return f;
+    }
+
+    // Compute the layer zdd_sequence[step] from the two layers
+    // just before it. kind is recorded in the statistics.
+    ZBDD computeLayer(const std::vector<ZBDD>& zdd_sequence, int step,
+                      StepKind kind)
+    {
+        ZBDD previous_zdd = ZBDD(0); // empty zdd
+        if (step >= 2) {
+            previous_zdd = zdd_sequence[step - 2];
+        }
+        return getNextStep(zdd_sequence[step - 1], previous_zdd, step, kind);
+    }
+
+    // Remove from the step-th layer f the sets that cannot be on
+    // a reconfiguration sequence to prune_goal_set_ of length at most
+    // prune_bound_. One step changes |X \Delta t| by at most 2 * jump_k_
+    // (one for TAR).
+    ZBDD pruneLayer(const ZBDD& f, int step)
+    {
+        int remaining = prune_bound_ - step;
+        int d = (model_ == TAR ? remaining : 2 * jump_k_ * remaining);
+        SymmetricDifferenceSpec spec(prune_goal_set_, num_elements_, d);
+        DdStructure<2> dd(spec);
+        ZBDD pruned_zdd = f & dd.evaluate(ToZBDD());
+        if (pruned_zdd != f) {
+            has_pruned_ = true;
+        }
+        return pruned_zdd;
+    }
+
+    bool isCheckpointLayer(int j) const
+    {
+        return j == 0 || j % current_interval_ == 0
+            || (j + 1) % current_interval_ == 0;
+    }
+
+    // Called after zdd_sequence[step] is constructed. The layers
+    // before zdd_sequence[step - 1] are no longer needed by the search,
+    // so they are stored into files (--zdddir) or dropped if they are
+    // not checkpoint layers.
+    void releaseLayers(std::vector<ZBDD>& zdd_sequence, int step)
+    {
+        if (!is_zdd_store_ && !is_checkpoint_) {
+            return;
+        }
+        if (step < 2) {
+            return;
+        }
+        if (is_zdd_store_) {
+            storeLayer(zdd_sequence, step - 2);
+            // The nodes of the spilled layer are freed only by GC.
+            if (is_gc_) {
+                BDD_GC();
+            }
+            return;
+        }
+        if (checkpoint_interval_ == 0
+            && step > current_interval_ * current_interval_) {
+            current_interval_ *= 2;
+            for (int j = 1; j < step - 1; ++j) {
+                if (!isCheckpointLayer(j)) {
+                    zdd_sequence[j] = ZBDD(-1);
+                }
+            }
+            if (show_info_) {
+                std::cerr << "(checkpoint interval = "
+                          << current_interval_ << ") ";
+            }
+            if (is_gc_) {
+                BDD_GC();
+            }
+        } else if (!isCheckpointLayer(step - 2)) {
+            zdd_sequence[step - 2] = ZBDD(-1);
+        }
+    }
+
+    void storeLayer(std::vector<ZBDD>& zdd_sequence, int j)
+    {
+        std::stringstream ss;
+        ss << zdd_dirname_ << j;
+        FILE* fp = fopen(ss.str().c_str(), "w");
+        if (fp == NULL) {
+            std::cerr << "File cannot be opened" << std::endl;
+            exit(6);
+        }
+        zdd_sequence[j].Export(fp);
+        fclose(fp);
+        zdd_sequence[j] = ZBDD(-1);
+    }
+
+    // Make zdd_sequence[i] available again. The layer is read from
+    // the file (--zdddir) or reconstructed from the nearest checkpoint.
+    void restoreLayer(std::vector<ZBDD>& zdd_sequence, int i)
+    {
+        ZBDD zbdd_null = ZBDD(-1);
+        if (is_zdd_store_) {
+            std::stringstream ss;
+            ss << zdd_dirname_ << i;
+            FILE* fp = fopen(ss.str().c_str(), "r");
+            if (fp == NULL) {
+                std::cerr << "File cannot be opened" << std::endl;
+                exit(6);
+            }
+            zdd_sequence[i] = ZBDD_Import(fp);
+            fclose(fp);
+            return;
+        }
+        int c = i - 1;
+        while (c > 0 && (zdd_sequence[c] == zbdd_null
+                         || zdd_sequence[c - 1] == zbdd_null)) {
+            --c;
+        }
+        if (show_info_) {
+            std::cerr << "Rebuild layers " << (c + 1) << ".." << i
+                      << " from checkpoint " << c << std::endl;
+        }
+        // suppress the per-step output of getNextStep while rebuilding
+        bool show_info = show_info_;
+        show_info_ = false;
+        for (int k = c + 1; k <= i; ++k) {
+            zdd_sequence[k] = computeLayer(zdd_sequence, k, STEP_REBUILD);
+        }
+        show_info_ = show_info;
+    }
+
+    // Return the family of all the sets obtained from a set in f
+    // by one step of the model.
+    ZBDD getNeighbors(const ZBDD& f)
+    {
+        ZBDD neighbor_zdd;
+        if (is_breadth_first_ && model_ == TJ) {
+            neighbor_zdd = swapElementBf(f, num_elements_);
+        } else if (is_breadth_first_ && model_ == TAR) {
+            neighbor_zdd = removeElementBf(f) + addElementBf(f, num_elements_);
+        } else if (model_ == TJ) {
+            neighbor_zdd = swapElement(f, num_elements_);
+        } else if (model_ == TAR) {
+            neighbor_zdd = removeElement(f) + addElement(f, num_elements_);
+        } else if (model_ == TS) {
+            neighbor_zdd = swapAdjacentElement(f, ts_interned_elements_,
+                                               ts_interned_adjacent_);
+        }
+        return neighbor_zdd;
+    }
+
+    // Return getNeighbors(f) & g. For TJ and TAR, it is computed
+    // without constructing getNeighbors(f). For TJ over a uniform
+    // solution space and for TJ with jump_k_ >= 2 (where getNeighbors()
+    // is not used), the sets in f are not contained in the result
+    // even if they are neighbors of other sets in f (every caller
+    // removes them or passes a single set as f).
+    ZBDD getNeighborsAnd(const ZBDD& f, const ZBDD& g)
+    {
+        ZBDD neighbor_zdd;
+        if (model_ == TJ && jump_k_ >= 2) {
+            // Y is obtained from X by jumping at most jump_k_ tokens
+            // iff |X \ Y| = |Y \ X| <= jump_k_.
+            neighbor_zdd = jumpElementAnd(f, g, jump_k_) - f;
+        } else if (is_breadth_first_) {
+            neighbor_zdd = getNeighbors(f) & g;
+        } else if (model_ == TJ && is_uniform_) {
+            // Y is obtained from X by one jump iff |X \Delta Y| = 2.
+            // The sets in f themselves are removed by the subtraction.
+            neighbor_zdd = withinDistance(f, g, 2) - f;
+        } else if (model_ == TJ) {
+            neighbor_zdd = swapElementAnd(f, g);
         } else if (model_ == TAR) {
-            next_zdd = removeElement(current_zdd)
-                + addElement(current_zdd, num_elements_);
+            neighbor_zdd = removeElementAnd(f, g) + addElementAnd(f, g);
+        } else {
+            neighbor_zdd = getNeighbors(f) & g;
+        }
+        return neighbor_zdd;
+    }
+
+    // Split f into at most num_shards disjoint subfamilies whose union
+    // is f. The largest shard is repeatedly divided into the sets
+    // containing its top variable and the others. A shard is kept as
+    // rests[i] with the variables fixed[i] removed, which all of its
+    // sets contain, so that the top variable of rests[i] always branches.
+    std::vector<ZBDD> splitLayer(const ZBDD& f, int num_shards)
+    {
+        std::vector<ZBDD> rests;
+        std::vector<std::vector<bddvar> > fixed;
+        rests.push_back(f);
+        fixed.push_back(std::vector<bddvar>());
+        while (static_cast<int>(rests.size()) < num_shards) {
+            int largest = -1;
+            for (size_t i = 0; i < rests.size(); ++i) {
+                if (rests[i].Top() == 0) { // constant
+                    continue;
+                }
+                if (largest < 0
+                    || rests[i].Size() > rests[largest].Size()) {
+                    largest = static_cast<int>(i);
+                }
+            }
+            if (largest < 0) {
+                break;
+            }
+            bddvar v = rests[largest].Top();
+            ZBDD on_zdd = rests[largest].OnSet0(v);
+            std::vector<bddvar> on_fixed = fixed[largest];
+            on_fixed.push_back(v);
+            rests[largest] = rests[largest].OffSet(v);
+            rests.push_back(on_zdd);
+            fixed.push_back(on_fixed);
+        }
+        std::vector<ZBDD> shards;
+        for (size_t i = 0; i < rests.size(); ++i) {
+            if (rests[i] == ZBDD(0)) {
+                continue;
+            }
+            ZBDD shard = rests[i];
+            for (size_t j = 0; j < fixed[i].size(); ++j) {
+                shard = shard.Change(fixed[i][j]);
+            }
+            shards.push_back(shard);
+        }
+        return shards;
+    }
+
+#ifndef _WIN32
+    // Compute getNeighborsAnd(f, g) by expanding the shards of f
+    // in num_procs_ child processes. Each child writes the time it took
+    // and its result (by ZBDD::Export) into a temporary file.
+    ZBDD getNeighborsAndSharded(const ZBDD& f, const ZBDD& g)
+    {
+        std::vector<ZBDD> shards = splitLayer(f, num_procs_);
+        std::vector<std::string> filenames(shards.size());
+        std::vector<pid_t> pids(shards.size());
+
+        std::cout.flush();
+        std::cerr.flush();
+        for (size_t i = 0; i < shards.size(); ++i) {
+            std::stringstream ss;
+            ss << "/tmp/ddreconf." << getpid() << "." << i;
+            filenames[i] = ss.str();
+            pids[i] = fork();
+            if (pids[i] < 0) {
+                std::cerr << "Cannot create a process" << std::endl;
+                exit(1);
+            } else if (pids[i] == 0) { // child
+                double start_time = getTime();
+                ZBDD h = getNeighborsAnd(shards[i], g);
+                if (h == ZBDD(-1)) {
+                    _exit(1);
+                }
+                FILE* fp = fopen(filenames[i].c_str(), "w");
+                if (fp == NULL) {
+                    _exit(6);
+                }
+                fprintf(fp, "%f\n", getTime() - start_time);
+                h.Export(fp);
+                fclose(fp);
+                _exit(0);
+            }
+        }
+
+        ZBDD result_zdd = ZBDD(0);
+        for (size_t i = 0; i < shards.size(); ++i) {
+            int status;
+            if (waitpid(pids[i], &status, 0) < 0 || !WIFEXITED(status)
+                || WEXITSTATUS(status) != 0) {
+                std::cerr << "The process for shard " << i
+                          << " failed" << std::endl;
+                exit(1);
+            }
+            FILE* fp = fopen(filenames[i].c_str(), "r");
+            if (fp == NULL) {
+                std::cerr << "File cannot be opened" << std::endl;
+                exit(6);
+            }
+            double shard_time = 0.0;
+            if (fscanf(fp, "%lf", &shard_time) != 1) {
+                std::cerr << "File " << filenames[i]
+                          << " is broken" << std::endl;
+                exit(6);
+            }
+            ZBDD h = ZBDD_Import(fp);
+            fclose(fp);
+            remove(filenames[i].c_str());
+            if (show_info_) {
+                std::cerr << "(shard " << i << ": # input ZDD nodes = "
+                          << shards[i].Size() << ", time = " << shard_time
+                          << ", # output ZDD nodes = " << h.Size() << ") ";
+            }
+            result_zdd += h;
+        }
+        return result_zdd;
+    }
+#endif
+
+    // Sum of the counters of all the operators in bddc_reconf.c
+    static struct reconf_stat getTotalOpStat()
+    {
+        struct reconf_stat total = {0, 0, 0, 0};
+        for (int i = 0; i < RECONF_NUM_STATS; ++i) {
+            struct reconf_stat stat;
+            reconf_get_stat(i, &stat);
+            total.calls += stat.calls;
+            total.lookups += stat.lookups;
+            total.hits += stat.hits;
+            total.nodes += stat.nodes;
+        }
+        return total;
+    }
+
+    // Compute the layer next to current_zdd, which is the step-th layer
+    // (step and kind are only recorded in the statistics).
+    ZBDD getNextStep(const ZBDD& current_zdd, const ZBDD& previous_zdd,
+                     int step, StepKind kind)
+    {
+        struct reconf_stat op_stat_before = {0, 0, 0, 0};
+        if (is_stats_) {
+            op_stat_before = getTotalOpStat();
         }
+        double start_time = getTime();
+        double total_start_time = start_time;
+#ifndef _WIN32
+        ZBDD next_zdd = (num_procs_ >= 2
+                         ? getNeighborsAndSharded(current_zdd,
+                                                  solution_space_zdd_)
+                         : getNeighborsAnd(current_zdd, solution_space_zdd_));
+#else
+        ZBDD next_zdd = getNeighborsAnd(current_zdd, solution_space_zdd_);
+#endif
         if (next_zdd == ZBDD(-1)) {
             std::cerr << "Cannot construct the remove/add/swap ZDD due to the memory shortage" << std::endl;
             exit(1);
         }
         double end_time = getTime();
-        if (show_info_verbose_) {
-            std::cerr << "time = " << (end_time - start_time) << std::endl;
-            std::cerr << "size = " << next_zdd.Size() << std::endl;
-            std::cerr << "card = " << getCard(next_zdd) << std::endl;
-        }
-
-        start_time = getTime();
-        next_zdd = solution_space_zdd_ & next_zdd;
-        end_time = getTime();
+        double neighbor_time = end_time - start_time;
         if (show_info_verbose_) {
             std::cerr << "time = " << (end_time - start_time) << std::endl;
             std::cerr << "size = " << next_zdd.Size() << std::endl;
@@ -283,15 +1341,50 @@ public:
         start_time = getTime();
         next_zdd = next_zdd - current_zdd - previous_zdd;
         end_time = getTime();
+
+        // pruning by the distance to the goal set (--prune)
+        double prune_time = 0.0;
+        std::string pruned_card; // only computed for the info output
+        if (is_pruning_) {
+            double prune_start_time = getTime();
+            ZBDD pruned_zdd = pruneLayer(next_zdd, step);
+            prune_time = getTime() - prune_start_time;
+            if (show_info_ || show_info_verbose_) {
+                pruned_card = getCard(next_zdd - pruned_zdd);
+            }
+            next_zdd = pruned_zdd;
+        }
+        if (is_stats_) {
+            struct reconf_stat op_stat = getTotalOpStat();
+            StepStat st;
+            st.step = step;
+            st.kind = kind;
+            st.neighbor_time = neighbor_time;
+            st.subtract_time = end_time - start_time;
+            st.prune_time = prune_time;
+            st.num_nodes = next_zdd.Size();
+            st.calls = op_stat.calls - op_stat_before.calls;
+            st.lookups = op_stat.lookups - op_stat_before.lookups;
+            st.hits = op_stat.hits - op_stat_before.hits;
+            st.nodes = op_stat.nodes - op_stat_before.nodes;
+            step_stats_.push_back(st);
+        }
         if (show_info_verbose_) {
             std::cerr << "time = " << (end_time - start_time) << std::endl;
             std::cerr << "size = " << next_zdd.Size() << std::endl;
             std::cerr << "card = " << getCard(next_zdd) << std::endl;
+            if (is_pruning_) {
+                std::cerr << "pruned = " << pruned_card << std::endl;
+            }
         } else if (show_info_) {
             DDNodeIndex index(next_zdd, false);
             std::cerr << "time = " << (getTime() - total_start_time)
                       << ", # ZDD nodes = " << index.size()
-                      << ", # elems = " << getCard(next_zdd) << std::endl;
+                      << ", # elems = " << getCard(next_zdd);
+            if (is_pruning_) {
+                std::cerr << ", # pruned = " << pruned_card;
+            }
+            std::cerr << std::endl;
         }
         if (next_zdd == ZBDD(-1)) {
             std::cerr << "Cannot construct a ZDD due to the memory shortage" << std::endl;
@@ -319,23 +1412,40 @@ public:
             }
         }
         ZBDD start_zdd = getSingleSet(start_set);
+        restrictToStartSize(start_zdd);
         F_.push_back(start_zdd);
         ZBDD goal_zdd = getSingleSet(goal_set);
         Fg_.push_back(goal_zdd);
 
         int step;
         for (step = 1; ; ++step) {
+            // Every monotone order of extending the two sides is correct:
+            // the pair (|F_| - 1, |Fg_| - 1) passes through every total
+            // number of steps, so the first nonempty intersection of
+            // the last layers gives the shortest length.
+            bool is_forward;
+            if (is_balanced_) {
+                is_forward = (F_.back().Size() <= Fg_.back().Size());
+            } else {
+                is_forward = (step % 2 == 1);
+            }
             if (show_info_) {
-                std::cerr << "Step " << step << " ";
+                std::cerr << "Step " << step << " ("
+                          << (is_forward ? "Zs_" : "Zt_")
+                          << (is_forward ? F_.size() : Fg_.size())
+                          << ") ";
             }
-            std::vector<ZBDD>& Fc = (step % 2 == 1 ? F_ : Fg_);
+            std::vector<ZBDD>& Fc = (is_forward ? F_ : Fg_);
 
             ZBDD previous_zdd = ZBDD(0); // empty zdd
             if (Fc.size() >= 2) {
                 previous_zdd = Fc[Fc.size() - 2];
             }
 
-            ZBDD next_zdd = getNextStep(Fc.back(), previous_zdd);
+            ZBDD next_zdd = getNextStep(Fc.back(), previous_zdd,
+                                        static_cast<int>(Fc.size()),
+                                        (&Fc == &F_ ? STEP_FORWARD
+                                         : STEP_BACKWARD));
             if (next_zdd.Card() == 0) {
                 return -1;
             }
@@ -361,6 +1471,32 @@ public:
     // representing the number of steps
     int reconfigureForWidth(const std::set<bddvar>& start_set,
                             const std::set<bddvar>& goal_set)
+    {
+        int shortest_length = reconfigureShortestSpace(start_set, goal_set);
+        if (shortest_length < 0) {
+            return -1;
+        }
+        BigInteger max_card(0);
+        int max_card_i = -1;
+        for (int i = 0; i <= shortest_length; ++i) {
+            int rev = shortest_length - i;
+            std::cerr << "Card(Zs_" << i << " & Zt_" << rev << ") = "
+                      << P_counts_[i] << std::endl;
+            if (max_card < P_counts_[i]) {
+                max_card = P_counts_[i];
+                max_card_i = i;
+            }
+        }
+        std::cerr << "max card = " << max_card << std::endl;
+        std::cerr << "max card index = " << max_card_i << std::endl;
+        return shortest_length;
+    }
+
+    // Construct P_ and P_counts_ by the search from both start_set
+    // and goal_set. Return -1 if the reconf seq is not found, and
+    // otherwise the number of steps of a shortest reconf seq.
+    int reconfigureShortestSpace(const std::set<bddvar>& start_set,
+                                 const std::set<bddvar>& goal_set)
     {
         assert(mode_ == ST);
 
@@ -378,6 +1514,7 @@ public:
             }
         }
         ZBDD start_zdd = getSingleSet(start_set);
+        restrictToStartSize(start_zdd);
         F_.push_back(start_zdd);
         ZBDD goal_zdd = getSingleSet(goal_set);
         Fg_.push_back(goal_zdd);
@@ -399,7 +1536,10 @@ public:
                 previous_zdd = Fc[Fc.size() - 2];
             }
 
-            ZBDD next_zdd = getNextStep(Fc.back(), previous_zdd);
+            ZBDD next_zdd = getNextStep(Fc.back(), previous_zdd,
+                                        static_cast<int>(Fc.size()),
+                                        (&Fc == &F_ ? STEP_FORWARD
+                                         : STEP_BACKWARD));
             if (next_zdd.Card() == 0) {
                 return -1;
             }
@@ -422,29 +1562,37 @@ public:
                 BDD_GC();
             }
         }
-        int max_card = 0;
-        int max_card_i = -1;
-        for (int i = 0; i <= shortest_length; ++i) {
-            int rev = shortest_length - i;
-            int card = (F_[i] & Fg_[rev]).Card();
-            std::cerr << "Card(Zs_" << i << " & Zt_" << rev << ") = " << card << std::endl;
-            if (card > max_card) {
-                max_card = card;
-                max_card_i = i;
-            }
+        if (!found_shortest) {
+            return -1;
+        }
+        constructShortestSpace(shortest_length);
+        return shortest_length;
+    }
+
+    // Construct P_ and P_counts_ from F_[0..length] and Fg_[0..length],
+    // where F_[i] (resp. Fg_[i]) consists of the sets whose distance
+    // from the start set (resp. the goal set) is i.
+    void constructShortestSpace(int length)
+    {
+        P_.clear();
+        P_counts_.clear();
+        for (int i = 0; i <= length; ++i) {
+            P_.push_back(F_[i] & Fg_[length - i]);
+            P_counts_.push_back(ZBDD_CountSolutions(P_.back()));
         }
-        std::cerr << "max card = " << max_card << std::endl;
-        std::cerr << "max card index = " << max_card_i << std::endl;
-        return (found_shortest ? shortest_length : -1);
     }
 
-    // Assume that zdd_sequence[0] is a ZDD containing only start_set,
+    // Assume that zdd_sequence[0] is the family of the start sets,
     // and zdd_sequence[size - 1] is a ZDD containing goal_set.
+    // The first set of output_sequence is the start set from which
+    // the found sequence starts.
     // Note that the content of zdd_sequence is erased.
-    void backtrack(const std::set<bddvar>& start_set,
-                   const std::set<bddvar>& goal_set,
+    // If explicit_layers is given, the layers zdd_sequence[i] with
+    // i < explicit_layers->size() are replaced by (*explicit_layers)[i].
+    void backtrack(const std::set<bddvar>& goal_set,
                    std::vector<ZBDD>& zdd_sequence,
-                   std::list<std::set<bddvar> >* output_sequence)
+                   std::list<std::set<bddvar> >* output_sequence,
+                   const std::vector<ExplicitLayer>* explicit_layers = NULL)
     {
         std::set<bddvar> current_set = goal_set;
 
@@ -453,78 +1601,58 @@ public:
         ZBDD zbdd_null = ZBDD(-1);
 
         for (int i = static_cast<int>(zdd_sequence.size()) - 2;
-                 i >= 1; --i) {
-            bool found_elem = false;
-            if (model_ == TJ) {
-                for (int v = 1; v <= num_elements_; ++v) {
-                    if (current_set.count(v) > 0) { // v found
-                        for (int w = 1; w <= num_elements_; ++w) {
-                            if (v != w) {
-                                if (current_set.count(w) == 0) { // w not found
-                                    current_set.insert(w);
-                                    current_set.erase(v);
-                                    if (isMemberZ(zdd_sequence[i], current_set)) {
-                                        found_elem = true;
-                                        break;
-                                    }
-                                    current_set.insert(v);
-                                    current_set.erase(w);
-                                }
-                            }
-                        }
-                        if (found_elem) {
-                            break;
-                        }
-                    }
-                }
-            } else if (model_ == TAR) {
-                for (int v = 1; v <= num_elements_; ++v) {
-                    if (current_set.count(v) > 0) { // v found
-                        current_set.erase(v);
-                        if (isMemberZ(zdd_sequence[i], current_set)) {
-                            found_elem = true;
-                            break;
-                        }
-                        current_set.insert(v);
-                    } else { // v not found
-                        current_set.insert(v);
-                        if (isMemberZ(zdd_sequence[i], current_set)) {
-                            found_elem = true;
-                            break;
-                        }
-                        current_set.erase(v);
-                    }
+                 i >= 0; --i) {
+            // zdd_sequence[i + 1] is no longer used
+            zdd_sequence[i + 1] = zbdd_null;
+            if (explicit_layers != NULL
+                && i < static_cast<int>(explicit_layers->size())) {
+                if (backtrackExplicit((*explicit_layers)[i], &current_set)) {
+                    output_sequence->push_front(current_set);
+                } else {
+                    std::cerr << "backtrack failed" << std::endl;
                 }
+                continue;
+            }
+            if (zdd_sequence[i] == zbdd_null) {
+                restoreLayer(zdd_sequence, i);
             }
-            if (found_elem) {
+            // All the models are symmetric, so the predecessors of
+            // current_set are its neighbors in zdd_sequence[i].
+            ZBDD candidate_zdd = getNeighborsAnd(getSingleSet(current_set),
+                                                 zdd_sequence[i]);
+            if (candidate_zdd == ZBDD(-1)) {
+                std::cerr << "Cannot construct a ZDD due to the memory shortage" << std::endl;
+                exit(1);
+            }
+            if (candidate_zdd != ZBDD(0)) {
+                current_set = pickRandomly(candidate_zdd, random_);
                 output_sequence->push_front(current_set);
             } else {
                 std::cerr << "backtrack failed" << std::endl;
             }
-            if (is_zdd_store_ && i >= 1002 && i % 1000 == 2) {
-                for (int j = i - 1000 - 1; j < i - 1; ++j) {
-                    std::stringstream ss;
-                    ss << zdd_dirname_ << j;
-                    FILE* fp = fopen(ss.str().c_str(), "r");
-                    if (fp == NULL) {
-                        std::cerr << "File cannot be opened" << std::endl;
-                        exit(6);
-                    }
-                    zdd_sequence[j] = ZBDD_Import(fp);
-                    fclose(fp);
-                    //std::cout << "restored " << j << " " << zdd_sequence[j].Size() << std::endl;
-                }
-                for (int j = i; j < i + 1000 && j < static_cast<int>(zdd_sequence.size()) - 1; ++j) {
-                    zdd_sequence[j] = zbdd_null;
-                //    std::cout << "erased " << j << std::endl;
-                }
-                BDD_GC();
+        }
+    }
+
+    // Replace *current_set with a set chosen uniformly at random from
+    // its neighbors in layer. Return false if there is no such set.
+    bool backtrackExplicit(const ExplicitLayer& layer,
+                           std::set<bddvar>* current_set)
+    {
+        std::vector<PackedSet> neighbors;
+        getExplicitNeighbors(PackedSet(num_elements_, *current_set),
+                             &neighbors);
+        std::vector<PackedSet> candidates;
+        for (size_t j = 0; j < neighbors.size(); ++j) {
+            if (layer.count(neighbors[j]) > 0) {
+                candidates.push_back(neighbors[j]);
             }
         }
-        // zdd_sequence.size() == 1 means that start_set == goal_set (0 step)
-        if (zdd_sequence.size() >= 2) {
-            output_sequence->push_front(start_set);
+        if (candidates.empty()) {
+            return false;
         }
+        *current_set = candidates[random_.GenRandUInt64()
+                                  % candidates.size()].toSet();
+        return true;
     }
 
     // Output the reconfiguration sequence
@@ -537,7 +1665,9 @@ public:
             for (std::set<bddvar>::const_iterator it2 = vec.begin();
                  it2 != vec.end(); ++it2) {
                 if (is_edge_variable_) {
-                    elems.push_back(num_elements_ + 1 - *it2);
+                    int e = num_elements_ + 1 - *it2;
+                    elems.push_back(edge_numbers_.empty()
+                                    ? e : edge_numbers_[e]);
                 } else {
                     elems.push_back(getVertexNumber(graph_, *it2));
                 }
@@ -22,18 +22,63 @@
 #ifndef SOLUTION_SPACE_HPP
 #define SOLUTION_SPACE_HPP
 
+#include "ConjunctionScheduler.hpp"
+
 class SolutionSpace {
 protected:
     int num_elements_;
+    // If true, DdStructure constructs and reduces the ZDDs in parallel
+    // (effective only if compiled with OpenMP).
+    bool use_mp_;
+    // If true, the solution space is constructed as the intersection of
+    // the ZDDs of the constraints by ConjunctionScheduler
+    // (for independent sets, vertex covers, cliques and dominating sets).
+    bool use_conj_;
+    int conj_group_size_;
+
+    // Intersect all the constraints in scheduler. If there is no
+    // constraint, the power set is returned.
+    ZBDD conjoinConstraints(ConjunctionScheduler& scheduler, bool show_info)
+    {
+        std::vector<bddvar> vararr;
+        for (int i = 0; i < num_elements_; ++i) {
+            vararr.push_back(i + 1);
+        }
+        size_t num_constraints = scheduler.getNumConstraints();
+        double start_time = getTime();
+        ZBDD f = scheduler.conjoin(sbddh::getPowerSet(vararr));
+        if (show_info) {
+            std::cerr << "Conjunction of " << num_constraints
+                      << " constraints: time = " << (getTime() - start_time)
+                      << ", peak # ZDD nodes = " << scheduler.getPeakSize()
+                      << std::endl;
+        }
+        return f;
+    }
 
 public:
-    SolutionSpace(int num_elements) : num_elements_(num_elements) { }
+    SolutionSpace(int num_elements) : num_elements_(num_elements),
+                                      use_mp_(false), use_conj_(false),
+                                      conj_group_size_(0) { }
+
+    void setUseMultiProcessors(bool use_mp)
+    {
+        use_mp_ = use_mp;
+    }
 
     int getNumElements()
     {
         return num_elements_;
     }
 
+    // Construct the solution space by ConjunctionScheduler with
+    // the given group size if the subclass supports it.
+    void setConjunctionScheduler(int group_size)
+    {
+        use_conj_ = true;
+        conj_group_size_ = group_size;
+    }
+
     virtual ZBDD createSolutionSpaceZdd() = 0;
 };
 
@@ -69,10 +69,10 @@ public:
                 std::string vs = oss.str();
                 dc.setConstraint(vs, &zero_or_two);
             }
-            dd = DdStructure<2>(dc);
+            dd = DdStructure<2>(dc, use_mp_);
             dd.zddSubset(fbs);
         } else {
-            dd = DdStructure<2>(fbs);
+            dd = DdStructure<2>(fbs, use_mp_);
         }
 
         ZBDD z = dd.evaluate(ToZBDD());
@@ -0,0 +1,64 @@
+//
+// SymmetricDifferenceSpec.hpp
+//
+// Copyright (c) 2020 -- 2022 Jun Kawahara and project "Fusion of Computer Science, Engineering
+//     and Mathematics Approaches for Expanding Combinatorial Reconfiguration"
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+// and associated documentation files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+// BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef SYMMETRIC_DIFFERENCE_SPEC_HPP
+#define SYMMETRIC_DIFFERENCE_SPEC_HPP
+
+#include <set>
+
+// The family of all the sets X over {1,...,n} such that
+// |X \Delta t| <= d, where \Delta is the symmetric difference.
+class SymmetricDifferenceSpec : public tdzdd::DdSpec<SymmetricDifferenceSpec, int, 2> {
+private:
+    const std::set<bddvar> t_;
+    const int n_;
+    const int d_;
+
+public:
+    SymmetricDifferenceSpec(const std::set<bddvar>& t, int n, int d)
+        : t_(t), n_(n), d_(d)
+    { }
+
+    int getRoot(int& state) const {
+        if (d_ < 0) {
+            return 0;
+        }
+        state = 0; // the number of elements in X \Delta t so far
+        return (n_ >= 1 ? n_ : -1);
+    }
+
+    int getChild(int& state, int level, int value) const {
+        if ((value == 1) != (t_.count(level) > 0)) {
+            ++state;
+            if (state > d_) {
+                return 0;
+            }
+        }
+
+        if (level == 1) {
+            return -1;
+        } else {
+            return level - 1;
+        }
+    }
+};
+
+#endif // SYMMETRIC_DIFFERENCE_SPEC_HPP
@@ -29,6 +29,12 @@ inline double getTime()
     return tv.tv_sec + tv.tv_usec * 1e-6;
 }
 
+// CPU time consumed by all the threads of the process
+inline double getCpuTime()
+{
+    return static_cast<double>(clock()) / CLOCKS_PER_SEC;
+}
+
 std::string getCard(ZBDD f)
 {
     SapporoZdd s(f);
@@ -232,6 +238,61 @@ void parse_stfile(const char* filename, Graph* graph, std::set<bddvar>* start_se
     }
 }
 
+// Read all the 't' lines in the file. Each line is one goal set.
+void parse_tfile(const char* filename, Graph* graph,
+                 std::vector<std::set<bddvar> >* goal_sets,
+                 bool is_edge_variable)
+{
+    std::ifstream ifs;
+    ifs.open(filename);
+    if (!ifs) {
+        std::cerr << "File " << filename << " cannot be opened." << std::endl;
+        exit(1);
+    }
+
+    std::string s;
+    while (ifs && std::getline(ifs, s)) {
+        if (s[0] == 't') {
+            goal_sets->push_back(std::set<bddvar>());
+            std::set<bddvar>* vec = &goal_sets->back();
+            std::istringstream iss(s);
+            std::string st;
+            bddvar bv;
+            iss >> st; // skip first char
+            while (iss >> bv) {
+                if (is_edge_variable) {
+                    vec->insert(bv);
+                } else {
+                    vec->insert(outerVertexToInner(*graph, bv));
+                }
+            }
+        }
+    }
+}
+
+void getAllSetsInner(const ZBDD& f, std::set<bddvar>* current_set,
+                     std::vector<std::set<bddvar> >* sets)
+{
+    if (f == ZBDD(0)) {
+        return;
+    } else if (f == ZBDD(1)) {
+        sets->push_back(*current_set);
+        return;
+    }
+    int v = f.Top();
+    getAllSetsInner(f.OffSet(v), current_set, sets);
+    current_set->insert(v);
+    getAllSetsInner(f.OnSet0(v), current_set, sets);
+    current_set->erase(v);
+}
+
+// Store all the sets in f into sets.
+void getAllSets(const ZBDD& f, std::vector<std::set<bddvar> >* sets)
+{
+    std::set<bddvar> current_set;
+    getAllSetsInner(f, &current_set, sets);
+}
+
 std::set<bddvar> pickRandomly(const ZBDD& f, BigIntegerRandom& random)
 {
     ZBDD_CountMap cmap;
@@ -256,6 +317,31 @@ void printSet(std::ostream& ost, const std::set<bddvar>& s,
     ost << std::endl;
 }
 
+// Return the family obtained from f by replacing each variable v
+// with var_map[v]. var_map must be injective on the variables of f.
+ZBDD permuteVariables(const ZBDD& f, const std::vector<bddvar>& var_map,
+                      std::map<bddp, ZBDD>* memo)
+{
+    if (f == ZBDD(0) || f == ZBDD(1)) {
+        return f;
+    }
+    std::map<bddp, ZBDD>::const_iterator itor = memo->find(f.GetID());
+    if (itor != memo->end()) {
+        return itor->second;
+    }
+    bddvar v = f.Top();
+    ZBDD result = permuteVariables(f.OffSet(v), var_map, memo)
+        + permuteVariables(f.OnSet0(v), var_map, memo).Change(var_map[v]);
+    memo->insert(std::make_pair(f.GetID(), result));
+    return result;
+}
+
+ZBDD permuteVariables(const ZBDD& f, const std::vector<bddvar>& var_map)
+{
+    std::map<bddp, ZBDD> memo;
+    return permuteVariables(f, var_map, &memo);
+}
+
 template<typename T>
 T inverseSet(const T& s, int n)
 {
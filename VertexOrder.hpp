@@ -0,0 +1,184 @@
+//
+// VertexOrder.hpp
+//
+// Copyright (c) 2020 -- 2022 Jun Kawahara and project "Fusion of Computer Science, Engineering
+//     and Mathematics Approaches for Expanding Combinatorial Reconfiguration"
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+// and associated documentation files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+// BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef VERTEX_ORDER_HPP
+#define VERTEX_ORDER_HPP
+
+#include <vector>
+#include <set>
+#include <string>
+#include <queue>
+#include <algorithm>
+
+// Reordering of the vertices of a graph for the solution spaces whose
+// variables are vertices. The inner vertex v of a tdzdd::Graph
+// corresponds to the variable at level v, and the inner vertex numbers
+// are given in the order of the first appearance in the edge list.
+// Therefore, the graph is relabeled by rebuilding it with the same
+// vertex names (outer vertex numbers) and the reordered edge list.
+
+// adjacent_lists[v]: the list of the neighbors of the inner vertex v
+inline std::vector<std::vector<int> > getAdjacentLists(const Graph& graph)
+{
+    std::vector<std::vector<int> > adjacent_lists(graph.vertexSize() + 1);
+    for (int i = 0; i < graph.edgeSize(); ++i) {
+        const Graph::EdgeInfo& edge = graph.edgeInfo(i);
+        if (edge.v1 != edge.v2) {
+            adjacent_lists[edge.v1].push_back(edge.v2);
+            adjacent_lists[edge.v2].push_back(edge.v1);
+        }
+    }
+    return adjacent_lists;
+}
+
+// The maximum size of the frontier when the vertices are processed
+// from level n to level 1, where the frontier at level l consists of
+// the vertices u > l having a neighbor <= l (as IndependentSetSpec).
+inline int getVertexFrontierWidth(const Graph& graph)
+{
+    const int n = graph.vertexSize();
+    // diff[l]: (# of vertices entering the frontier at level l)
+    //          - (# of vertices leaving the frontier at level l)
+    std::vector<int> diff(n + 2, 0);
+    std::vector<std::vector<int> > adjacent_lists = getAdjacentLists(graph);
+    for (int u = 1; u <= n; ++u) {
+        int lowest = u;
+        for (size_t i = 0; i < adjacent_lists[u].size(); ++i) {
+            lowest = std::min(lowest, adjacent_lists[u][i]);
+        }
+        if (lowest < u) { // u is in the frontier at levels lowest,...,u-1
+            ++diff[u - 1];
+            --diff[lowest - 1];
+        }
+    }
+    int width = 0;
+    int current = 0;
+    for (int l = n; l >= 1; --l) {
+        current += diff[l];
+        width = std::max(width, current);
+    }
+    return width;
+}
+
+// Compute the Cuthill-McKee order of the inner vertices, that is,
+// the BFS order starting from a vertex of the minimum degree in each
+// connected component, where the unvisited neighbors of each vertex are
+// visited in the ascending order of their degrees.
+// order[i] is the inner vertex placed at the (i + 1)-th position.
+inline std::vector<int> getCuthillMcKeeOrder(const Graph& graph)
+{
+    const int n = graph.vertexSize();
+    std::vector<std::vector<int> > adjacent_lists = getAdjacentLists(graph);
+    std::vector<std::pair<size_t, int> > degrees;
+    for (int v = 1; v <= n; ++v) {
+        degrees.push_back(std::make_pair(adjacent_lists[v].size(), v));
+    }
+    std::sort(degrees.begin(), degrees.end());
+
+    std::vector<int> order;
+    std::vector<bool> visited(n + 1, false);
+    for (size_t k = 0; k < degrees.size(); ++k) {
+        int root = degrees[k].second;
+        if (visited[root]) {
+            continue;
+        }
+        visited[root] = true;
+        std::queue<int> que;
+        que.push(root);
+        while (!que.empty()) {
+            int u = que.front();
+            que.pop();
+            order.push_back(u);
+            std::vector<std::pair<size_t, int> > children;
+            for (size_t i = 0; i < adjacent_lists[u].size(); ++i) {
+                int w = adjacent_lists[u][i];
+                if (!visited[w]) {
+                    visited[w] = true;
+                    children.push_back(std::make_pair(adjacent_lists[w].size(), w));
+                }
+            }
+            std::sort(children.begin(), children.end());
+            for (size_t i = 0; i < children.size(); ++i) {
+                que.push(children[i].second);
+            }
+        }
+    }
+    return order;
+}
+
+// Rebuild graph into new_graph so that the inner vertex order[i] of graph
+// becomes the inner vertex i + 1 of new_graph. order must be a BFS order
+// (such as the Cuthill-McKee order) in which the vertices discovered from
+// the same vertex are placed consecutively. Each edge is put in the
+// position of its endpoint placed first and sorted by the other endpoint,
+// so every vertex first appears in the edge from the vertex discovering it.
+// If edge_order is not NULL, (*edge_order)[j] is set to the edge number
+// of graph that becomes the edge j of new_graph.
+inline void reorderGraph(const Graph& graph, const std::vector<int>& order,
+                         Graph* new_graph, std::vector<int>* edge_order = NULL)
+{
+    const int n = graph.vertexSize();
+    std::vector<int> position(n + 1, 0);
+    for (size_t i = 0; i < order.size(); ++i) {
+        position[order[i]] = static_cast<int>(i) + 1;
+    }
+    // buckets[p]: the pairs (position of the other endpoint, edge number)
+    // of the edges whose endpoint placed first is at position p
+    std::vector<std::vector<std::pair<int, int> > > buckets(n + 1);
+    for (int i = 0; i < graph.edgeSize(); ++i) {
+        const Graph::EdgeInfo& edge = graph.edgeInfo(i);
+        int p1 = position[edge.v1];
+        int p2 = position[edge.v2];
+        buckets[std::min(p1, p2)].push_back(std::make_pair(std::max(p1, p2), i));
+    }
+    new_graph->clear();
+    if (edge_order != NULL) {
+        edge_order->clear();
+    }
+    for (int p = 1; p <= n; ++p) {
+        std::sort(buckets[p].begin(), buckets[p].end());
+        for (size_t i = 0; i < buckets[p].size(); ++i) {
+            const Graph::EdgeInfo& edge = graph.edgeInfo(buckets[p][i].second);
+            int u = (position[edge.v1] <= position[edge.v2] ? edge.v1 : edge.v2);
+            int w = (u == edge.v1 ? edge.v2 : edge.v1);
+            new_graph->addEdge(graph.vertexName(u), graph.vertexName(w));
+            if (edge_order != NULL) {
+                edge_order->push_back(buckets[p][i].second);
+            }
+        }
+    }
+    new_graph->update();
+}
+
+// translate the inner vertex numbers of graph in s into those of new_graph
+inline std::set<bddvar> remapVertexSet(const std::set<bddvar>& s,
+                                       const Graph& graph,
+                                       const Graph& new_graph)
+{
+    std::set<bddvar> ns;
+    for (std::set<bddvar>::const_iterator itor = s.begin();
+         itor != s.end(); ++itor) {
+        ns.insert(new_graph.getVertex(graph.vertexName(*itor)));
+    }
+    return ns;
+}
+
+#endif // VERTEX_ORDER_HPP
@@ -39,4 +39,68 @@ inline ZBDD swapElement(const ZBDD& f, int n)
     return ZBDD_ID(swap_element(f.GetID(), n));
 }
 
+// The same as removeElement, addElement and swapElement, respectively,
+// except that they process the ZDD level by level without recursion.
+// Used when the number of variables exceeds the recursion limit.
+inline ZBDD removeElementBf(const ZBDD& f)
+{
+    return ZBDD_ID(remove_element_bf(f.GetID()));
+}
+
+inline ZBDD addElementBf(const ZBDD& f, int n)
+{
+    return ZBDD_ID(add_element_bf(f.GetID(), n));
+}
+
+inline ZBDD swapElementBf(const ZBDD& f, int n)
+{
+    return ZBDD_ID(swap_element_bf(f.GetID(), n));
+}
+
+// elements: the variables sorted in the descending order of their levels,
+//           terminated by -1.
+// adjacent[v]: the variables adjacent to v sorted in the same way,
+//              terminated by -1.
+// The results are cached only if elements and adjacent are obtained
+// by reconf_intern_adjacent.
+inline ZBDD swapAdjacentElement(const ZBDD& f, int* elements, int** adjacent)
+{
+    return ZBDD_ID(swap_adjacent_element(f.GetID(), elements, adjacent));
+}
+
+// The following three functions compute removeElement(f) & g,
+// addElement(f, n) & g and swapElement(f, n) & g, respectively,
+// in one pass without constructing the left operand of &.
+inline ZBDD removeElementAnd(const ZBDD& f, const ZBDD& g)
+{
+    return ZBDD_ID(remove_element_and(f.GetID(), g.GetID()));
+}
+
+inline ZBDD addElementAnd(const ZBDD& f, const ZBDD& g)
+{
+    return ZBDD_ID(add_element_and(f.GetID(), g.GetID()));
+}
+
+inline ZBDD swapElementAnd(const ZBDD& f, const ZBDD& g)
+{
+    return ZBDD_ID(swap_element_and(f.GetID(), g.GetID()));
+}
+
+// Return the family of the sets Y in g such that |X \Delta Y| <= d
+// for some X in f, where \Delta is the symmetric difference.
+// If all the sets in f and g have the same size, |X \Delta Y| is twice
+// the number of tokens that must jump to change X into Y.
+inline ZBDD withinDistance(const ZBDD& f, const ZBDD& g, int d)
+{
+    return ZBDD_ID(within_distance(f.GetID(), g.GetID(), d));
+}
+
+// Return the family of the sets Y in g obtained from some X in f by
+// jumping at most k tokens at once, that is, |X \ Y| = |Y \ X| <= k.
+// The sets in f & g themselves are contained in the result.
+inline ZBDD jumpElementAnd(const ZBDD& f, const ZBDD& g, int k)
+{
+    return ZBDD_ID(jump_element_and(f.GetID(), g.GetID(), k));
+}
+
 #endif // _ZBDD_reconf_
@@ -25,8 +25,254 @@
 #define BC_REMOVEE    40
 #define BC_ADDE       41
 #define BC_SWAPE      42
+#define BC_REMOVEEAND 43
+#define BC_ADDEAND    44
+#define BC_SWAPEAND   45
+#define BC_REMOVESE   46
+#define BC_ADDSE      47
+#define BC_SWAPSE     48
+#define BC_SWAPAE     49
+/* within_distance(f, g, d) uses BC_WITHIN + d (0 <= d <= BC_WITHIN_MAXD) */
+#define BC_WITHIN     50
+#define BC_WITHIN_MAXD 9
+/* jump_element_and uses BC_JUMP + r * 8 + a (0 <= r, a <= BC_JUMP_MAXK) */
+#define BC_JUMP       100
+#define BC_JUMP_MAXK  RECONF_JUMP_MAXK
+
+/* The cache is shared with the operators of SAPPOROBDD. The BC_* codes
+   of bddc.c, BDD.h and ZBDD.h were checked not to lie in 40-59 or
+   100-163, so the codes above must stay in these ranges. */
+#if BC_WITHIN + BC_WITHIN_MAXD > 59 || BC_JUMP + BC_JUMP_MAXK * 9 > 163
+#error "the op codes of bddc_reconf.c overlap those of SAPPOROBDD"
+#endif
 
 #include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Statistics of the operators. BC_REMOVEE, ..., BC_SWAPAE are
+   counted in reconf_stats[0], ..., reconf_stats[9], all the
+   BC_WITHIN + d are counted in reconf_stats[10], and all the
+   BC_JUMP + r * 8 + a are counted in reconf_stats[11]. */
+static struct reconf_stat reconf_stats[RECONF_NUM_STATS];
+
+static const char* reconf_stat_names[RECONF_NUM_STATS] = {
+    "remove_element", "add_element", "swap_element",
+    "remove_element_and", "add_element_and", "swap_element_and",
+    "remove_specified_element", "add_specified_element",
+    "swap_specified_element", "swap_adjacent_element",
+    "within_distance", "jump_element_and"
+};
+
+#define RECONF_STAT_INDEX(op) \
+    ((op) >= BC_JUMP ? 11 : ((op) >= BC_WITHIN ? 10 : (op) - BC_REMOVEE))
+#define RECONF_STAT_CALL(op) (++reconf_stats[RECONF_STAT_INDEX(op)].calls)
+#define RECONF_STAT_LOOKUP(op) (++reconf_stats[RECONF_STAT_INDEX(op)].lookups)
+#define RECONF_STAT_HIT(op) (++reconf_stats[RECONF_STAT_INDEX(op)].hits)
+#define RECONF_STAT_NODE(op) (++reconf_stats[RECONF_STAT_INDEX(op)].nodes)
+
+void reconf_get_stat(int i, struct reconf_stat* stat)
+{
+    *stat = reconf_stats[i];
+}
+
+const char* reconf_stat_name(int i)
+{
+    return reconf_stat_names[i];
+}
+
+void reconf_clear_stats(void)
+{
+    memset(reconf_stats, 0, sizeof(reconf_stats));
+}
+
+/* Store the 0-child and the 1-child of f with respect to the variable
+   at level lev into *f0 and *f1. If the top level of f is lower than lev,
+   f does not depend on the variable. */
+static void cofactor_at_level(bddp f, bddvar lev, bddp* f0, bddp* f1)
+{
+    struct B_NodeTable *fp;
+
+    if (B_CST(f) || Var[B_VAR_NP(B_NP(f))].lev < lev) {
+        *f0 = f;
+        *f1 = bddfalse;
+        return;
+    }
+    fp = B_NP(f);
+    *f0 = B_GET_BDDP(fp->f0);
+    if (!B_NEG(f)) {
+        *f0 = B_NOT(*f0);
+    }
+    *f1 = B_GET_BDDP(fp->f1);
+}
+
+static bddvar top_level(bddp f)
+{
+    if (B_CST(f)) {
+        return 0;
+    }
+    return Var[B_VAR_NP(B_NP(f))].lev;
+}
+
+/* Look up the cache entry of (op, f, g). Return bddnull on a miss. */
+static bddp lookup_cache2(unsigned char op, bddp f, bddp g, bddp* key)
+{
+    struct B_CacheTable *cachep;
+    struct B_NodeTable *fp;
+    bddp h;
+
+    if (B_CST(f) || B_CST(g)) {
+        *key = bddnull;
+        return bddnull;
+    }
+    *key = B_CACHEKEY(op, f, g);
+    cachep = Cache + *key;
+    RECONF_STAT_LOOKUP(op);
+    if (cachep->op == op &&
+        f == B_GET_BDDP(cachep->f) &&
+        g == B_GET_BDDP(cachep->g)) {
+        RECONF_STAT_HIT(op);
+        /* Hit */
+        h = B_GET_BDDP(cachep->h);
+        if(!B_CST(h) && h != bddnull) { fp = B_NP(h); B_RFC_INC_NP(fp); }
+        return h;
+    }
+    return bddnull;
+}
+
+static void store_cache2(unsigned char op, bddp f, bddp g, bddp h, bddp key)
+{
+    struct B_CacheTable *cachep;
+
+    if (key != bddnull && h != bddnull) {
+        cachep = Cache + key;
+        cachep->op = op;
+        B_SET_BDDP(cachep->f, f);
+        B_SET_BDDP(cachep->g, g);
+        B_SET_BDDP(cachep->h, h);
+    }
+}
+
+/* The arrays passed to the *_specified_element and
+   swap_adjacent_element functions are usually not cached because the
+   cache is keyed by bddp. If the arrays are interned by the following
+   functions, each position in them gets a small integer key, and the
+   results are cached with the key as the second operand. */
+
+struct reconf_region {
+    int* begin;
+    int* end;
+    bddp key_base;
+};
+
+static struct reconf_region* reconf_regions = NULL;
+static int reconf_num_regions = 0;
+static int reconf_regions_capacity = 0;
+/* keys are never reused so that old cache entries do not match */
+static bddp reconf_next_key = 1;
+
+static int* reconf_new_region(int len)
+{
+    int* p;
+    struct reconf_region* regions;
+
+    if (reconf_num_regions >= reconf_regions_capacity) {
+        reconf_regions_capacity = (reconf_regions_capacity == 0 ?
+                                   8 : reconf_regions_capacity * 2);
+        regions = (struct reconf_region*)realloc(reconf_regions,
+            sizeof(struct reconf_region) * reconf_regions_capacity);
+        if (regions == NULL) {
+            return NULL;
+        }
+        reconf_regions = regions;
+    }
+    p = (int*)malloc(sizeof(int) * len);
+    if (p == NULL) {
+        return NULL;
+    }
+    reconf_regions[reconf_num_regions].begin = p;
+    reconf_regions[reconf_num_regions].end = p + len;
+    reconf_regions[reconf_num_regions].key_base = reconf_next_key;
+    ++reconf_num_regions;
+    reconf_next_key += len;
+    return p;
+}
+
+/* Return the key of position p, or bddnull if p is not interned. */
+static bddp reconf_key(const int* p)
+{
+    int i;
+
+    for (i = 0; i < reconf_num_regions; ++i) {
+        if (reconf_regions[i].begin <= p && p < reconf_regions[i].end) {
+            return reconf_regions[i].key_base
+                + (bddp)(p - reconf_regions[i].begin);
+        }
+    }
+    return bddnull;
+}
+
+static int reconf_array_length(const int* elements)
+{
+    int len = 0;
+
+    while (elements[len] >= 0) {
+        ++len;
+    }
+    return len + 1; /* including the terminator -1 */
+}
+
+/* Return an interned copy of elements (terminated by -1),
+   or NULL on the memory shortage. */
+int* reconf_intern_elements(const int* elements)
+{
+    int len = reconf_array_length(elements);
+    int* p = reconf_new_region(len);
+
+    if (p != NULL) {
+        memcpy(p, elements, sizeof(int) * len);
+    }
+    return p;
+}
+
+/* Intern elements and adjacent[0], ..., adjacent[n - 1] for
+   swap_adjacent_element. The interned copy of elements is used only
+   together with *adjacent_out. Return 0 on success and -1 on
+   the memory shortage. */
+int reconf_intern_adjacent(const int* elements, int* const* adjacent, int n,
+                           int** elements_out, int*** adjacent_out)
+{
+    int i, total = 0;
+    int* pool;
+    int** table;
+
+    for (i = 0; i < n; ++i) {
+        total += reconf_array_length(adjacent[i]);
+    }
+    table = (int**)malloc(sizeof(int*) * n);
+    if (table == NULL) {
+        return -1;
+    }
+    pool = reconf_new_region(total);
+    if (pool == NULL) {
+        free(table);
+        return -1;
+    }
+    for (i = 0; i < n; ++i) {
+        int len = reconf_array_length(adjacent[i]);
+        memcpy(pool, adjacent[i], sizeof(int) * len);
+        table[i] = pool;
+        pool += len;
+    }
+    *elements_out = reconf_intern_elements(elements);
+    if (*elements_out == NULL) {
+        free(table);
+        return -1;
+    }
+    *adjacent_out = table;
+    return 0;
+}
+
 
 bddp remove_element(bddp f)
 {
@@ -38,6 +284,7 @@ bddp remove_element(bddp f)
     if (f == bddnull) {
         return bddnull;
     }
+    RECONF_STAT_CALL(BC_REMOVEE);
 
     if (f == bddfalse || f == bddtrue) {
         return bddfalse;
@@ -54,10 +301,12 @@ bddp remove_element(bddp f)
         key = bddnull;
     } else {
         key = B_CACHEKEY(BC_REMOVEE, f, (bddp)bddempty);
+        RECONF_STAT_LOOKUP(BC_REMOVEE);
         cachep = Cache + key;
         if (cachep->op == BC_REMOVEE &&
             f == B_GET_BDDP(cachep->f) &&
             (bddp)bddempty == B_GET_BDDP(cachep->g)) {
+            RECONF_STAT_HIT(BC_REMOVEE);
             /* Hit */
             h = B_GET_BDDP(cachep->h);
             if(!B_CST(h) && h != bddnull) { fp = B_NP(h); B_RFC_INC_NP(fp); }
@@ -85,6 +334,7 @@ bddp remove_element(bddp f)
         bddfree(r1);
         return bddnull;
     }
+    RECONF_STAT_NODE(BC_REMOVEE);
 
     if (key != bddnull && h != bddnull) {
         cachep = Cache + key;
@@ -100,13 +350,13 @@ bddp remove_element(bddp f)
 bddp remove_specified_element(bddp f, int* elements)
 {
     struct B_NodeTable *fp;
-    struct B_CacheTable *cachep;
-    bddp f0, f1, r0, r1, h, key;
+    bddp f0, f1, r0, r1, h, key, gkey;
     bddvar var, lev;
 
     if (f == bddnull) {
         return bddnull;
     }
+    RECONF_STAT_CALL(BC_REMOVESE);
 
     if (f == bddfalse || f == bddtrue) {
         return bddfalse;
@@ -127,20 +377,15 @@ bddp remove_specified_element(bddp f, int* elements)
     }
 
     /* Checking Cache */
-    /*if (B_RFC_ONE_NP(fp)) {
+    gkey = reconf_key(elements);
+    if (gkey == bddnull) {
         key = bddnull;
     } else {
-        key = B_CACHEKEY(BC_REMOVEE, f, (bddp)bddempty);
-        cachep = Cache + key;
-        if (cachep->op == BC_REMOVEE &&
-            f == B_GET_BDDP(cachep->f) &&
-            (bddp)bddempty == B_GET_BDDP(cachep->g)) {*/
-            /* Hit */
-    /*        h = B_GET_BDDP(cachep->h);
-            if(!B_CST(h) && h != bddnull) { fp = B_NP(h); B_RFC_INC_NP(fp); }
+        h = lookup_cache2(BC_REMOVESE, f, gkey, &key);
+        if (h != bddnull) {
             return h;
         }
-    }*/
+    }
 
     if (bddlevofvar(*elements) == lev) {
         ++elements;
@@ -175,14 +420,9 @@ bddp remove_specified_element(bddp f, int* elements)
         bddfree(r1);
         return bddnull;
     }
+    RECONF_STAT_NODE(BC_REMOVESE);
 
-    /*if (key != bddnull && h != bddnull) {
-        cachep = Cache + key;
-        cachep->op = BC_REMOVEE;
-        B_SET_BDDP(cachep->f, f);
-        B_SET_BDDP(cachep->g, (bddp)bddempty);
-        B_SET_BDDP(cachep->h, h);
-    }*/
+    store_cache2(BC_REMOVESE, f, gkey, h, key);
 
     return h;
 }
@@ -197,6 +437,7 @@ bddp add_element(bddp f, int n)
     if (f == bddnull) {
         return bddnull;
     }
+    RECONF_STAT_CALL(BC_ADDE);
 
     if (f == bddfalse) {
         return bddfalse;
@@ -224,10 +465,12 @@ bddp add_element(bddp f, int n)
         key = bddnull;
     } else {
         key = B_CACHEKEY(BC_ADDE, f, (bddp)n);
+        RECONF_STAT_LOOKUP(BC_ADDE);
         cachep = Cache + key;
         if (cachep->op == BC_ADDE &&
             f == B_GET_BDDP(cachep->f) &&
             (bddp)n == B_GET_BDDP(cachep->g)) {
+            RECONF_STAT_HIT(BC_ADDE);
             /* Hit */
             h = B_GET_BDDP(cachep->h);
             if(!B_CST(h) && h != bddnull) { fp = B_NP(h); B_RFC_INC_NP(fp); }
@@ -276,6 +519,7 @@ bddp add_element(bddp f, int n)
         bddfree(r1);
         return bddnull;
     }
+    RECONF_STAT_NODE(BC_ADDE);
 
     if (key != bddnull && h != bddnull) {
         cachep = Cache + key;
@@ -291,13 +535,13 @@ bddp add_element(bddp f, int n)
 bddp add_specified_element(bddp f, int* elements)
 {
     struct B_NodeTable *fp;
-    struct B_CacheTable *cachep;
-    bddp f0, f1, r0, r1, h, key;
+    bddp f0, f1, r0, r1, h, key, gkey;
     bddvar flev, v;
 
     if (f == bddnull) {
         return bddnull;
     }
+    RECONF_STAT_CALL(BC_ADDSE);
 
     if (f == bddfalse) {
         return bddfalse;
@@ -316,22 +560,15 @@ bddp add_specified_element(bddp f, int* elements)
     }
 
     /* Checking Cache */
-    /*if (f == bddtrue) {
-        key = bddnull;
-    } else if (B_RFC_ONE_NP(fp)) {
+    gkey = reconf_key(elements);
+    if (gkey == bddnull) {
         key = bddnull;
     } else {
-        key = B_CACHEKEY(BC_ADDE, f, (bddp)n);
-        cachep = Cache + key;
-        if (cachep->op == BC_ADDE &&
-            f == B_GET_BDDP(cachep->f) &&
-            (bddp)n == B_GET_BDDP(cachep->g)) {
-          *//* Hit *//*
-            h = B_GET_BDDP(cachep->h);
-            if(!B_CST(h) && h != bddnull) { fp = B_NP(h); B_RFC_INC_NP(fp); }
+        h = lookup_cache2(BC_ADDSE, f, gkey, &key);
+        if (h != bddnull) {
             return h;
         }
-    }*/
+    }
 
     if (bddlevofvar(*elements) < flev) {
         f0 = B_GET_BDDP(fp->f0);
@@ -395,14 +632,9 @@ bddp add_specified_element(bddp f, int* elements)
         bddfree(r1);
         return bddnull;
     }
+    RECONF_STAT_NODE(BC_ADDSE);
 
-    /*if (key != bddnull && h != bddnull) {
-        cachep = Cache + key;
-        cachep->op = BC_ADDE;
-        B_SET_BDDP(cachep->f, f);
-        B_SET_BDDP(cachep->g, (bddp)n);
-        B_SET_BDDP(cachep->h, h);
-    }*/
+    store_cache2(BC_ADDSE, f, gkey, h, key);
 
     return h;
 }
@@ -418,6 +650,7 @@ bddp swap_element(bddp f, int n)
     if (f == bddnull) {
         return bddnull;
     }
+    RECONF_STAT_CALL(BC_SWAPE);
 
     if (f == bddfalse || f == bddtrue) {
         return bddfalse;
@@ -433,10 +666,12 @@ bddp swap_element(bddp f, int n)
         key = bddnull;
     } else {
         key = B_CACHEKEY(BC_SWAPE, f, (bddp)n);
+        RECONF_STAT_LOOKUP(BC_SWAPE);
         cachep = Cache + key;
         if (cachep->op == BC_SWAPE &&
             f == B_GET_BDDP(cachep->f) &&
             (bddp)n == B_GET_BDDP(cachep->g)) {
+            RECONF_STAT_HIT(BC_SWAPE);
             /* Hit */
             h = B_GET_BDDP(cachep->h);
             if(!B_CST(h) && h != bddnull) { fp = B_NP(h); B_RFC_INC_NP(fp); }
@@ -500,6 +735,7 @@ bddp swap_element(bddp f, int n)
         bddfree(r1);
         return bddnull;
     }
+    RECONF_STAT_NODE(BC_SWAPE);
 
     if (key != bddnull && h != bddnull) {
         cachep = Cache + key;
@@ -515,13 +751,13 @@ bddp swap_element(bddp f, int n)
 bddp swap_specified_element(bddp f, int* elements)
 {
     struct B_NodeTable *fp;
-    struct B_CacheTable *cachep;
-    bddp f0, f1, r0, r1, h, h2, key;
+    bddp f0, f1, r0, r1, h, h2, key, gkey;
     bddvar flev, v;
 
     if (f == bddnull) {
         return bddnull;
     }
+    RECONF_STAT_CALL(BC_SWAPSE);
 
     if (f == bddfalse || f == bddtrue) {
         return bddfalse;
@@ -535,20 +771,15 @@ bddp swap_specified_element(bddp f, int* elements)
     flev = Var[B_VAR_NP(fp)].lev;
 
     /* Checking Cache */
-    /*if (B_RFC_ONE_NP(fp)) {
+    gkey = reconf_key(elements);
+    if (gkey == bddnull) {
         key = bddnull;
     } else {
-        key = B_CACHEKEY(BC_SWAPE, f, (bddp)n);
-        cachep = Cache + key;
-        if (cachep->op == BC_SWAPE &&
-            f == B_GET_BDDP(cachep->f) &&
-            (bddp)n == B_GET_BDDP(cachep->g)) {
-    *//* Hit *//*
-            h = B_GET_BDDP(cachep->h);
-            if(!B_CST(h) && h != bddnull) { fp = B_NP(h); B_RFC_INC_NP(fp); }
+        h = lookup_cache2(BC_SWAPSE, f, gkey, &key);
+        if (h != bddnull) {
             return h;
         }
-        }*/
+    }
 
     if (bddlevofvar(*elements) < flev) {
         f0 = B_GET_BDDP(fp->f0);
@@ -624,14 +855,9 @@ bddp swap_specified_element(bddp f, int* elements)
         bddfree(r1);
         return bddnull;
     }
+    RECONF_STAT_NODE(BC_SWAPSE);
 
-    /*if (key != bddnull && h != bddnull) {
-        cachep = Cache + key;
-        cachep->op = BC_SWAPE;
-        B_SET_BDDP(cachep->f, f);
-        B_SET_BDDP(cachep->g, (bddp)n);
-        B_SET_BDDP(cachep->h, h);
-        }*/
+    store_cache2(BC_SWAPSE, f, gkey, h, key);
 
     return h;
 }
@@ -639,14 +865,14 @@ bddp swap_specified_element(bddp f, int* elements)
 bddp swap_adjacent_element(bddp f, int* elements, int** adjacent)
 {
     struct B_NodeTable *fp;
-    struct B_CacheTable *cachep;
-    bddp f0, f1, r0, r1, h, h2, key;
+    bddp f0, f1, r0, r1, h, h2, key, gkey;
     bddvar flev, v;
     int* p;
 
     if (f == bddnull) {
         return bddnull;
     }
+    RECONF_STAT_CALL(BC_SWAPAE);
 
     if (f == bddfalse || f == bddtrue) {
         return bddfalse;
@@ -660,20 +886,15 @@ bddp swap_adjacent_element(bddp f, int* elements, int** adjacent)
     flev = Var[B_VAR_NP(fp)].lev;
 
     /* Checking Cache */
-    /*if (B_RFC_ONE_NP(fp)) {
+    gkey = reconf_key(elements);
+    if (gkey == bddnull) {
         key = bddnull;
     } else {
-        key = B_CACHEKEY(BC_SWAPE, f, (bddp)n);
-        cachep = Cache + key;
-        if (cachep->op == BC_SWAPE &&
-            f == B_GET_BDDP(cachep->f) &&
-            (bddp)n == B_GET_BDDP(cachep->g)) {
-    *//* Hit *//*
-            h = B_GET_BDDP(cachep->h);
-            if(!B_CST(h) && h != bddnull) { fp = B_NP(h); B_RFC_INC_NP(fp); }
+        h = lookup_cache2(BC_SWAPAE, f, gkey, &key);
+        if (h != bddnull) {
             return h;
         }
-        }*/
+    }
 
     if (bddlevofvar(*elements) < flev) {
         f0 = B_GET_BDDP(fp->f0);
@@ -755,14 +976,963 @@ bddp swap_adjacent_element(bddp f, int* elements, int** adjacent)
         bddfree(r1);
         return bddnull;
     }
+    RECONF_STAT_NODE(BC_SWAPAE);
 
-    /*if (key != bddnull && h != bddnull) {
-        cachep = Cache + key;
-        cachep->op = BC_SWAPE;
-        B_SET_BDDP(cachep->f, f);
-        B_SET_BDDP(cachep->g, (bddp)n);
-        B_SET_BDDP(cachep->h, h);
-        }*/
+    store_cache2(BC_SWAPAE, f, gkey, h, key);
+
+    return h;
+}
+
+/* remove_element(f) & g without constructing remove_element(f) */
+bddp remove_element_and(bddp f, bddp g)
+{
+    bddp f0, f1, g0, g1, r0, r1, h, h2, key;
+    bddvar lev;
+
+    if (f == bddnull || g == bddnull) {
+        return bddnull;
+    }
+    RECONF_STAT_CALL(BC_REMOVEEAND);
+
+    if (f == bddfalse || f == bddtrue || g == bddfalse) {
+        return bddfalse;
+    }
+
+    h = lookup_cache2(BC_REMOVEEAND, f, g, &key);
+    if (h != bddnull) {
+        return h;
+    }
+
+    lev = top_level(f);
+    if (top_level(g) > lev) {
+        lev = top_level(g);
+    }
+    cofactor_at_level(f, lev, &f0, &f1);
+    cofactor_at_level(g, lev, &g0, &g1);
+
+    /* 0-child: remove an element other than x from f0, or remove x from f1 */
+    h = remove_element_and(f0, g0);
+    if (h == bddnull) {
+        return bddnull;
+    }
+    h2 = bddintersec(f1, g0);
+    if (h2 == bddnull) {
+        bddfree(h);
+        return bddnull;
+    }
+    r0 = bddunion(h, h2);
+    bddfree(h);
+    bddfree(h2);
+    if (r0 == bddnull) {
+        return bddnull;
+    }
+    /* 1-child: remove an element other than x from f1 */
+    r1 = remove_element_and(f1, g1);
+    if (r1 == bddnull) {
+        bddfree(r0);
+        return bddnull;
+    }
+    h = getzbddp(bddvaroflev(lev), r0, r1);
+    if (h == bddnull) {
+        bddfree(r0);
+        bddfree(r1);
+        return bddnull;
+    }
+    RECONF_STAT_NODE(BC_REMOVEEAND);
+
+    store_cache2(BC_REMOVEEAND, f, g, h, key);
+
+    return h;
+}
+
+/* add_element(f, n) & g without constructing add_element(f, n),
+   where n is at least the top level of g */
+bddp add_element_and(bddp f, bddp g)
+{
+    bddp f0, f1, g0, g1, r0, r1, h, h2, key;
+    bddvar lev;
+
+    if (f == bddnull || g == bddnull) {
+        return bddnull;
+    }
+    RECONF_STAT_CALL(BC_ADDEAND);
+
+    if (f == bddfalse || g == bddfalse || g == bddtrue) {
+        return bddfalse;
+    }
+
+    h = lookup_cache2(BC_ADDEAND, f, g, &key);
+    if (h != bddnull) {
+        return h;
+    }
+
+    lev = top_level(f);
+    if (top_level(g) > lev) {
+        lev = top_level(g);
+    }
+    cofactor_at_level(f, lev, &f0, &f1);
+    cofactor_at_level(g, lev, &g0, &g1);
+
+    /* 0-child: add an element other than x to f0 */
+    r0 = add_element_and(f0, g0);
+    if (r0 == bddnull) {
+        return bddnull;
+    }
+    /* 1-child: add x to f0, or add an element other than x to f1 */
+    h = bddintersec(f0, g1);
+    if (h == bddnull) {
+        bddfree(r0);
+        return bddnull;
+    }
+    h2 = add_element_and(f1, g1);
+    if (h2 == bddnull) {
+        bddfree(h);
+        bddfree(r0);
+        return bddnull;
+    }
+    r1 = bddunion(h, h2);
+    bddfree(h);
+    bddfree(h2);
+    if (r1 == bddnull) {
+        bddfree(r0);
+        return bddnull;
+    }
+    h = getzbddp(bddvaroflev(lev), r0, r1);
+    if (h == bddnull) {
+        bddfree(r0);
+        bddfree(r1);
+        return bddnull;
+    }
+    RECONF_STAT_NODE(BC_ADDEAND);
+
+    store_cache2(BC_ADDEAND, f, g, h, key);
+
+    return h;
+}
+
+/* swap_element(f, n) & g without constructing swap_element(f, n),
+   where n is at least the top level of g */
+bddp swap_element_and(bddp f, bddp g)
+{
+    bddp f0, f1, g0, g1, r0, r1, h, h2, key;
+    bddvar lev;
+
+    if (f == bddnull || g == bddnull) {
+        return bddnull;
+    }
+    RECONF_STAT_CALL(BC_SWAPEAND);
+
+    /* a swap never produces the empty set */
+    if (f == bddfalse || f == bddtrue || g == bddfalse || g == bddtrue) {
+        return bddfalse;
+    }
+
+    h = lookup_cache2(BC_SWAPEAND, f, g, &key);
+    if (h != bddnull) {
+        return h;
+    }
+
+    lev = top_level(f);
+    if (top_level(g) > lev) {
+        lev = top_level(g);
+    }
+    cofactor_at_level(f, lev, &f0, &f1);
+    cofactor_at_level(g, lev, &g0, &g1);
+
+    /* 0-child: swap in f0 without x, or replace x in f1 with another */
+    h = swap_element_and(f0, g0);
+    if (h == bddnull) {
+        return bddnull;
+    }
+    h2 = add_element_and(f1, g0);
+    if (h2 == bddnull) {
+        bddfree(h);
+        return bddnull;
+    }
+    r0 = bddunion(h, h2);
+    bddfree(h);
+    bddfree(h2);
+    if (r0 == bddnull) {
+        return bddnull;
+    }
+    /* 1-child: swap in f1 keeping x, or replace another in f0 with x */
+    h = swap_element_and(f1, g1);
+    if (h == bddnull) {
+        bddfree(r0);
+        return bddnull;
+    }
+    h2 = remove_element_and(f0, g1);
+    if (h2 == bddnull) {
+        bddfree(h);
+        bddfree(r0);
+        return bddnull;
+    }
+    r1 = bddunion(h, h2);
+    bddfree(h);
+    bddfree(h2);
+    if (r1 == bddnull) {
+        bddfree(r0);
+        return bddnull;
+    }
+    h = getzbddp(bddvaroflev(lev), r0, r1);
+    if (h == bddnull) {
+        bddfree(r0);
+        bddfree(r1);
+        return bddnull;
+    }
+    RECONF_STAT_NODE(BC_SWAPEAND);
+
+    store_cache2(BC_SWAPEAND, f, g, h, key);
 
     return h;
 }
+
+/* The family of the sets Y in g such that |X \Delta Y| <= d
+   for some X in f. */
+bddp within_distance(bddp f, bddp g, int d)
+{
+    bddp f0, f1, g0, g1, r0, r1, h, h2, key;
+    bddvar lev;
+    unsigned char op;
+
+    if (f == bddnull || g == bddnull) {
+        return bddnull;
+    }
+    RECONF_STAT_CALL(BC_WITHIN);
+
+    if (f == bddfalse || g == bddfalse) {
+        return bddfalse;
+    }
+
+    if (d <= 0) {
+        return bddintersec(f, g);
+    }
+
+    if (f == bddtrue && g == bddtrue) {
+        return bddtrue;
+    }
+
+    if (d <= BC_WITHIN_MAXD) {
+        op = (unsigned char)(BC_WITHIN + d);
+        h = lookup_cache2(op, f, g, &key);
+        if (h != bddnull) {
+            return h;
+        }
+    } else {
+        op = 0; /* suppress warning */
+        key = bddnull;
+    }
+
+    lev = top_level(f);
+    if (top_level(g) > lev) {
+        lev = top_level(g);
+    }
+    cofactor_at_level(f, lev, &f0, &f1);
+    cofactor_at_level(g, lev, &g0, &g1);
+
+    /* 0-child: x is in neither X nor Y, or x is only in X */
+    h = within_distance(f0, g0, d);
+    if (h == bddnull) {
+        return bddnull;
+    }
+    h2 = within_distance(f1, g0, d - 1);
+    if (h2 == bddnull) {
+        bddfree(h);
+        return bddnull;
+    }
+    r0 = bddunion(h, h2);
+    bddfree(h);
+    bddfree(h2);
+    if (r0 == bddnull) {
+        return bddnull;
+    }
+    /* 1-child: x is in both X and Y, or x is only in Y */
+    h = within_distance(f1, g1, d);
+    if (h == bddnull) {
+        bddfree(r0);
+        return bddnull;
+    }
+    h2 = within_distance(f0, g1, d - 1);
+    if (h2 == bddnull) {
+        bddfree(h);
+        bddfree(r0);
+        return bddnull;
+    }
+    r1 = bddunion(h, h2);
+    bddfree(h);
+    bddfree(h2);
+    if (r1 == bddnull) {
+        bddfree(r0);
+        return bddnull;
+    }
+    h = getzbddp(bddvaroflev(lev), r0, r1);
+    if (h == bddnull) {
+        bddfree(r0);
+        bddfree(r1);
+        return bddnull;
+    }
+    RECONF_STAT_NODE(BC_WITHIN);
+
+    if (key != bddnull) {
+        store_cache2(op, f, g, h, key);
+    }
+
+    return h;
+}
+
+/* The sets Y in g such that |X \ Y| = |Y \ X| <= k for some X in f,
+   that is, Y is obtained from X by jumping at most k tokens at once.
+   jump_element_rec(f, g, r, a) is the family of the sets Y in g such
+   that |X \ Y| <= r, |Y \ X| <= a and |X \ Y| - |Y \ X| = r - a
+   for some X in f, where r and a are the numbers of tokens that can
+   still be removed and added, respectively. */
+static bddp jump_element_rec(bddp f, bddp g, int r, int a)
+{
+    bddp f0, f1, g0, g1, r0, r1, h, h2, key;
+    bddvar lev;
+    unsigned char op;
+
+    if (f == bddnull || g == bddnull) {
+        return bddnull;
+    }
+    RECONF_STAT_CALL(BC_JUMP);
+
+    if (f == bddfalse || g == bddfalse) {
+        return bddfalse;
+    }
+
+    if (r == 0 && a == 0) {
+        return bddintersec(f, g);
+    }
+
+    if (f == bddtrue && g == bddtrue) {
+        return (r == a ? bddtrue : bddfalse);
+    }
+
+    if (r <= BC_JUMP_MAXK && a <= BC_JUMP_MAXK) {
+        op = (unsigned char)(BC_JUMP + r * 8 + a);
+        h = lookup_cache2(op, f, g, &key);
+        if (h != bddnull) {
+            return h;
+        }
+    } else {
+        op = 0; /* suppress warning */
+        key = bddnull;
+    }
+
+    lev = top_level(f);
+    if (top_level(g) > lev) {
+        lev = top_level(g);
+    }
+    cofactor_at_level(f, lev, &f0, &f1);
+    cofactor_at_level(g, lev, &g0, &g1);
+
+    /* 0-child: x is in neither X nor Y, or x is removed from X */
+    h = jump_element_rec(f0, g0, r, a);
+    if (h == bddnull) {
+        return bddnull;
+    }
+    if (r > 0) {
+        h2 = jump_element_rec(f1, g0, r - 1, a);
+        if (h2 == bddnull) {
+            bddfree(h);
+            return bddnull;
+        }
+        r0 = bddunion(h, h2);
+        bddfree(h);
+        bddfree(h2);
+        if (r0 == bddnull) {
+            return bddnull;
+        }
+    } else {
+        r0 = h;
+    }
+    /* 1-child: x is in both X and Y, or x is added to X */
+    h = jump_element_rec(f1, g1, r, a);
+    if (h == bddnull) {
+        bddfree(r0);
+        return bddnull;
+    }
+    if (a > 0) {
+        h2 = jump_element_rec(f0, g1, r, a - 1);
+        if (h2 == bddnull) {
+            bddfree(h);
+            bddfree(r0);
+            return bddnull;
+        }
+        r1 = bddunion(h, h2);
+        bddfree(h);
+        bddfree(h2);
+        if (r1 == bddnull) {
+            bddfree(r0);
+            return bddnull;
+        }
+    } else {
+        r1 = h;
+    }
+    h = getzbddp(bddvaroflev(lev), r0, r1);
+    if (h == bddnull) {
+        bddfree(r0);
+        bddfree(r1);
+        return bddnull;
+    }
+    RECONF_STAT_NODE(BC_JUMP);
+
+    if (key != bddnull) {
+        store_cache2(op, f, g, h, key);
+    }
+
+    return h;
+}
+
+bddp jump_element_and(bddp f, bddp g, int k)
+{
+    if (k < 0) {
+        k = 0;
+    }
+    /* larger k would leave the states uncached */
+    if (k > BC_JUMP_MAXK) {
+        return bddnull;
+    }
+    return jump_element_rec(f, g, k, k);
+}
+
+/* Level-synchronous versions of remove_element, add_element and
+   swap_element. They do not recurse on the C stack. All the nodes of f
+   are collected with an explicit stack and sorted by level. The
+   demanded (node, level) pairs are propagated from the top level to the
+   bottom, and the results are constructed from the bottom level to the
+   top. The union of two ZDDs is computed by bddunion. */
+
+#define BF_REMOVE 0
+#define BF_ADD    1
+#define BF_SWAP   2
+
+struct bf_node {
+    bddp f;     /* the node (possibly complemented), or bddtrue */
+    bddvar lev;
+    int c0, c1; /* the indices of the children, -1 for bddfalse */
+    bddp r;     /* remove_element(f) */
+    int max_a;  /* the highest level demanded for add (-1: none) */
+    int max_s;  /* the highest level demanded for swap (-1: none) */
+};
+
+/* add_element(nodes[idx].f, lev) or swap_element(nodes[idx].f, lev) */
+struct bf_demand {
+    int idx;
+    int lev;
+    bddp val;
+};
+
+struct bf_context {
+    struct bf_node* nodes;
+    int num_nodes;
+    int nodes_capacity;
+    int* table; /* open addressing hash table from f to the index */
+    int table_capacity;
+    struct bf_demand* demands[2]; /* 0: add, 1: swap */
+    int num_demands[2];
+    int demands_capacity[2];
+};
+
+static struct bf_node* bf_sort_nodes;
+
+static int bf_compare_level(const void* a, const void* b)
+{
+    bddvar la = bf_sort_nodes[*(const int*)a].lev;
+    bddvar lb = bf_sort_nodes[*(const int*)b].lev;
+    return (la < lb ? -1 : (la > lb ? 1 : 0));
+}
+
+static int bf_compare_demand(const void* a, const void* b)
+{
+    const struct bf_demand* da = (const struct bf_demand*)a;
+    const struct bf_demand* db = (const struct bf_demand*)b;
+    if (da->idx != db->idx) {
+        return (da->idx < db->idx ? -1 : 1);
+    }
+    return (da->lev < db->lev ? -1 : (da->lev > db->lev ? 1 : 0));
+}
+
+static int bf_hash(bddp f, int capacity)
+{
+    return (int)((f * 0x9E3779B97F4A7C15ULL) >> 20) & (capacity - 1);
+}
+
+static int bf_rehash(struct bf_context* ctx)
+{
+    int i, h;
+    int capacity = ctx->table_capacity * 2;
+    int* table = (int*)malloc(sizeof(int) * capacity);
+
+    if (table == NULL) {
+        return -1;
+    }
+    for (i = 0; i < capacity; ++i) {
+        table[i] = -1;
+    }
+    for (i = 0; i < ctx->num_nodes; ++i) {
+        h = bf_hash(ctx->nodes[i].f, capacity);
+        while (table[h] >= 0) {
+            h = (h + 1) & (capacity - 1);
+        }
+        table[h] = i;
+    }
+    free(ctx->table);
+    ctx->table = table;
+    ctx->table_capacity = capacity;
+    return 0;
+}
+
+/* Return the index of f, adding it if it is new (*is_new is set to 1).
+   Return -1 for bddfalse and -2 on the memory shortage. */
+static int bf_get_index(struct bf_context* ctx, bddp f, int* is_new)
+{
+    int h;
+    struct bf_node* nodes;
+
+    *is_new = 0;
+    if (f == bddfalse) {
+        return -1;
+    }
+    h = bf_hash(f, ctx->table_capacity);
+    while (ctx->table[h] >= 0) {
+        if (ctx->nodes[ctx->table[h]].f == f) {
+            return ctx->table[h];
+        }
+        h = (h + 1) & (ctx->table_capacity - 1);
+    }
+    if (ctx->num_nodes >= ctx->nodes_capacity) {
+        ctx->nodes_capacity *= 2;
+        nodes = (struct bf_node*)realloc(ctx->nodes,
+            sizeof(struct bf_node) * ctx->nodes_capacity);
+        if (nodes == NULL) {
+            return -2;
+        }
+        ctx->nodes = nodes;
+    }
+    ctx->nodes[ctx->num_nodes].f = f;
+    ctx->nodes[ctx->num_nodes].lev = top_level(f);
+    ctx->nodes[ctx->num_nodes].c0 = -1;
+    ctx->nodes[ctx->num_nodes].c1 = -1;
+    ctx->nodes[ctx->num_nodes].r = bddfalse;
+    ctx->nodes[ctx->num_nodes].max_a = -1;
+    ctx->nodes[ctx->num_nodes].max_s = -1;
+    ctx->table[h] = ctx->num_nodes;
+    ++ctx->num_nodes;
+    *is_new = 1;
+    if (ctx->num_nodes * 2 > ctx->table_capacity) {
+        if (bf_rehash(ctx) != 0) {
+            return -2;
+        }
+    }
+    return ctx->num_nodes - 1;
+}
+
+/* Collect all the nodes of f. Return the index of f,
+   -1 if f is bddfalse and -2 on the memory shortage. */
+static int bf_collect(struct bf_context* ctx, bddp f)
+{
+    int root, idx, is_new, sp = 0, stack_capacity = 1024;
+    int* stack;
+    int* p;
+    bddp f0, f1;
+
+    root = bf_get_index(ctx, f, &is_new);
+    if (root < 0) {
+        return root;
+    }
+    stack = (int*)malloc(sizeof(int) * stack_capacity);
+    if (stack == NULL) {
+        return -2;
+    }
+    stack[sp++] = root;
+    while (sp > 0) {
+        idx = stack[--sp];
+        if (ctx->nodes[idx].f == bddtrue) {
+            continue;
+        }
+        cofactor_at_level(ctx->nodes[idx].f, ctx->nodes[idx].lev, &f0, &f1);
+        if (sp + 2 > stack_capacity) {
+            stack_capacity *= 2;
+            p = (int*)realloc(stack, sizeof(int) * stack_capacity);
+            if (p == NULL) {
+                free(stack);
+                return -2;
+            }
+            stack = p;
+        }
+        ctx->nodes[idx].c0 = bf_get_index(ctx, f0, &is_new);
+        if (ctx->nodes[idx].c0 == -2) {
+            free(stack);
+            return -2;
+        }
+        if (is_new) {
+            stack[sp++] = ctx->nodes[idx].c0;
+        }
+        ctx->nodes[idx].c1 = bf_get_index(ctx, f1, &is_new);
+        if (ctx->nodes[idx].c1 == -2) {
+            free(stack);
+            return -2;
+        }
+        if (is_new) {
+            stack[sp++] = ctx->nodes[idx].c1;
+        }
+    }
+    free(stack);
+    return root;
+}
+
+/* kind 0: add, 1: swap */
+static int bf_add_demand(struct bf_context* ctx, int kind, int idx, int lev)
+{
+    struct bf_demand* demands;
+
+    if (idx < 0) {
+        return 0;
+    }
+    if (ctx->num_demands[kind] >= ctx->demands_capacity[kind]) {
+        ctx->demands_capacity[kind] = (ctx->demands_capacity[kind] == 0 ?
+                                       1024 : ctx->demands_capacity[kind] * 2);
+        demands = (struct bf_demand*)realloc(ctx->demands[kind],
+            sizeof(struct bf_demand) * ctx->demands_capacity[kind]);
+        if (demands == NULL) {
+            return -1;
+        }
+        ctx->demands[kind] = demands;
+    }
+    ctx->demands[kind][ctx->num_demands[kind]].idx = idx;
+    ctx->demands[kind][ctx->num_demands[kind]].lev = lev;
+    ctx->demands[kind][ctx->num_demands[kind]].val = bddfalse;
+    ++ctx->num_demands[kind];
+    if (kind == 0) {
+        if (ctx->nodes[idx].max_a < lev) {
+            ctx->nodes[idx].max_a = lev;
+        }
+    } else {
+        if (ctx->nodes[idx].max_s < lev) {
+            ctx->nodes[idx].max_s = lev;
+        }
+    }
+    return 0;
+}
+
+/* Sort the demands and remove the duplicates. */
+static void bf_sort_demands(struct bf_context* ctx, int kind)
+{
+    int i, j = 0;
+    struct bf_demand* demands = ctx->demands[kind];
+
+    if (ctx->num_demands[kind] == 0) {
+        return;
+    }
+    qsort(demands, ctx->num_demands[kind], sizeof(struct bf_demand),
+          bf_compare_demand);
+    for (i = 1; i < ctx->num_demands[kind]; ++i) {
+        if (demands[i].idx != demands[j].idx
+            || demands[i].lev != demands[j].lev) {
+            ++j;
+            demands[j] = demands[i];
+        }
+    }
+    ctx->num_demands[kind] = j + 1;
+}
+
+/* Return the position of the demand (idx, lev), or the position of
+   the first demand of idx if lev < 0. Return -1 if not found. */
+static int bf_find_demand(struct bf_context* ctx, int kind, int idx, int lev)
+{
+    int lo = 0, hi = ctx->num_demands[kind], mid;
+    struct bf_demand key;
+
+    key.idx = idx;
+    key.lev = (lev < 0 ? -1 : lev);
+    while (lo < hi) {
+        mid = (lo + hi) / 2;
+        if (bf_compare_demand(&ctx->demands[kind][mid], &key) < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if (lo >= ctx->num_demands[kind] || ctx->demands[kind][lo].idx != idx) {
+        return -1;
+    }
+    if (lev >= 0 && ctx->demands[kind][lo].lev != lev) {
+        return -1;
+    }
+    return lo;
+}
+
+/* The value of the demand (idx, lev), which is not copied */
+static bddp bf_value(struct bf_context* ctx, int kind, int idx, int lev)
+{
+    int pos;
+
+    if (idx < 0) {
+        return bddfalse;
+    }
+    pos = bf_find_demand(ctx, kind, idx, lev);
+    assert(pos >= 0);
+    return ctx->demands[kind][pos].val;
+}
+
+static bddp bf_remove_value(struct bf_context* ctx, int idx)
+{
+    return (idx < 0 ? bddfalse : ctx->nodes[idx].r);
+}
+
+static bddp bf_f(struct bf_context* ctx, int idx)
+{
+    return (idx < 0 ? bddfalse : ctx->nodes[idx].f);
+}
+
+/* Construct the chain cur, node(lev + 1, cur, hi), node(lev + 2, ...),
+   ... up to level max_lev, storing the demanded levels of idx.
+   cur is consumed. Return 0 on success and -1 on the memory shortage. */
+static int bf_extend_chain(struct bf_context* ctx, int kind, int idx,
+                           int lev, int max_lev, bddp cur, bddp hi)
+{
+    int pos = bf_find_demand(ctx, kind, idx, -1);
+    int l;
+    bddp h, next;
+
+    for (l = lev; ; ++l) {
+        if (l > lev) {
+            h = bddcopy(hi);
+            if (h == bddnull) {
+                bddfree(cur);
+                return -1;
+            }
+            next = getzbddp(bddvaroflev(l), cur, h);
+            if (next == bddnull) {
+                bddfree(cur);
+                bddfree(h);
+                return -1;
+            }
+            cur = next;
+        }
+        while (pos >= 0 && pos < ctx->num_demands[kind]
+               && ctx->demands[kind][pos].idx == idx
+               && ctx->demands[kind][pos].lev < l) {
+            ++pos;
+        }
+        if (pos >= 0 && pos < ctx->num_demands[kind]
+            && ctx->demands[kind][pos].idx == idx
+            && ctx->demands[kind][pos].lev == l) {
+            ctx->demands[kind][pos].val = bddcopy(cur);
+        }
+        if (l >= max_lev) {
+            break;
+        }
+    }
+    bddfree(cur);
+    return 0;
+}
+
+/* Compute remove_element (op = BF_REMOVE), add_element or swap_element
+   of f at the levels of all the nodes. */
+static int bf_compute(struct bf_context* ctx, int op, int* order)
+{
+    int k, idx;
+    bddvar lev;
+    struct bf_node* node;
+    bddp h, r0, r1;
+
+    for (k = 0; k < ctx->num_nodes; ++k) {
+        idx = order[k];
+        node = &ctx->nodes[idx];
+        lev = node->lev;
+        if (node->f == bddtrue) {
+            node->r = bddfalse;
+            if (node->max_a >= 0) {
+                if (bf_extend_chain(ctx, 0, idx, 0, node->max_a,
+                                    bddfalse, bddtrue) != 0) {
+                    return -1;
+                }
+            }
+            /* swap_element(bddtrue, n) is always bddfalse */
+            continue;
+        }
+
+        /* remove: (remove(f0) | f1, remove(f1)) */
+        r0 = bddunion(bf_remove_value(ctx, node->c0), bf_f(ctx, node->c1));
+        if (r0 == bddnull) {
+            return -1;
+        }
+        r1 = bddcopy(bf_remove_value(ctx, node->c1));
+        node->r = getzbddp(bddvaroflev(lev), r0, r1);
+        if (node->r == bddnull) {
+            bddfree(r0);
+            bddfree(r1);
+            return -1;
+        }
+        if (op == BF_REMOVE) {
+            continue;
+        }
+
+        /* add: (add(f0), f0 | add(f1)) at the level of f */
+        if (node->max_a >= 0) {
+            r0 = bddcopy(bf_value(ctx, 0, node->c0, lev - 1));
+            r1 = bddunion(bf_f(ctx, node->c0),
+                          bf_value(ctx, 0, node->c1, lev - 1));
+            if (r1 == bddnull) {
+                bddfree(r0);
+                return -1;
+            }
+            h = getzbddp(bddvaroflev(lev), r0, r1);
+            if (h == bddnull) {
+                bddfree(r0);
+                bddfree(r1);
+                return -1;
+            }
+            if (bf_extend_chain(ctx, 0, idx, lev, node->max_a,
+                                h, node->f) != 0) {
+                return -1;
+            }
+        }
+
+        /* swap: (swap(f0) | add(f1), swap(f1) | remove(f0)) */
+        if (node->max_s >= 0) {
+            r0 = bddunion(bf_value(ctx, 1, node->c0, lev - 1),
+                          bf_value(ctx, 0, node->c1, lev - 1));
+            if (r0 == bddnull) {
+                return -1;
+            }
+            r1 = bddunion(bf_value(ctx, 1, node->c1, lev - 1),
+                          bf_remove_value(ctx, node->c0));
+            if (r1 == bddnull) {
+                bddfree(r0);
+                return -1;
+            }
+            h = getzbddp(bddvaroflev(lev), r0, r1);
+            if (h == bddnull) {
+                bddfree(r0);
+                bddfree(r1);
+                return -1;
+            }
+            if (bf_extend_chain(ctx, 1, idx, lev, node->max_s,
+                                h, node->r) != 0) {
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+static bddp bf_apply(int op, bddp f, int n)
+{
+    struct bf_context ctx;
+    int root, k, idx, kind;
+    int* order = NULL;
+    bddp result = bddnull;
+    struct bf_node* node;
+
+    if (f == bddnull) {
+        return bddnull;
+    }
+    if (f == bddfalse) {
+        return bddfalse;
+    }
+
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.nodes_capacity = 1024;
+    ctx.nodes = (struct bf_node*)malloc(sizeof(struct bf_node)
+                                        * ctx.nodes_capacity);
+    ctx.table_capacity = 2048;
+    ctx.table = (int*)malloc(sizeof(int) * ctx.table_capacity);
+    if (ctx.nodes == NULL || ctx.table == NULL) {
+        goto finish;
+    }
+    for (k = 0; k < ctx.table_capacity; ++k) {
+        ctx.table[k] = -1;
+    }
+
+    root = bf_collect(&ctx, f);
+    if (root < 0) {
+        goto finish;
+    }
+    assert(op == BF_REMOVE || (int)ctx.nodes[root].lev <= n);
+
+    /* sort the nodes in the ascending order of their levels */
+    order = (int*)malloc(sizeof(int) * ctx.num_nodes);
+    if (order == NULL) {
+        goto finish;
+    }
+    for (k = 0; k < ctx.num_nodes; ++k) {
+        order[k] = k;
+    }
+    bf_sort_nodes = ctx.nodes;
+    qsort(order, ctx.num_nodes, sizeof(int), bf_compare_level);
+
+    /* propagate the demands from the top */
+    if (op != BF_REMOVE) {
+        if (bf_add_demand(&ctx, (op == BF_ADD ? 0 : 1), root, n) != 0) {
+            goto finish;
+        }
+    }
+    for (k = ctx.num_nodes - 1; k >= 0; --k) {
+        node = &ctx.nodes[order[k]];
+        if (node->f == bddtrue) {
+            continue;
+        }
+        if (node->max_s >= 0) {
+            if (bf_add_demand(&ctx, 1, node->c0, node->lev - 1) != 0
+                || bf_add_demand(&ctx, 1, node->c1, node->lev - 1) != 0
+                || bf_add_demand(&ctx, 0, node->c1, node->lev - 1) != 0) {
+                goto finish;
+            }
+        }
+        if (node->max_a >= 0) {
+            if (bf_add_demand(&ctx, 0, node->c0, node->lev - 1) != 0
+                || bf_add_demand(&ctx, 0, node->c1, node->lev - 1) != 0) {
+                goto finish;
+            }
+        }
+    }
+    bf_sort_demands(&ctx, 0);
+    bf_sort_demands(&ctx, 1);
+
+    if (bf_compute(&ctx, op, order) != 0) {
+        goto finish;
+    }
+    if (op == BF_REMOVE) {
+        result = bddcopy(ctx.nodes[root].r);
+    } else if (op == BF_ADD) {
+        result = bddcopy(bf_value(&ctx, 0, root, n));
+    } else if (ctx.nodes[root].f == bddtrue) {
+        result = bddfalse;
+    } else {
+        result = bddcopy(bf_value(&ctx, 1, root, n));
+    }
+
+finish:
+    for (k = 0; k < ctx.num_nodes; ++k) {
+        bddfree(ctx.nodes[k].r);
+    }
+    for (kind = 0; kind < 2; ++kind) {
+        for (idx = 0; idx < ctx.num_demands[kind]; ++idx) {
+            bddfree(ctx.demands[kind][idx].val);
+        }
+        free(ctx.demands[kind]);
+    }
+    free(order);
+    free(ctx.table);
+    free(ctx.nodes);
+    return result;
+}
+
+bddp remove_element_bf(bddp f)
+{
+    return bf_apply(BF_REMOVE, f, 0);
+}
+
+bddp add_element_bf(bddp f, int n)
+{
+    return bf_apply(BF_ADD, f, n);
+}
+
+bddp swap_element_bf(bddp f, int n)
+{
+    return bf_apply(BF_SWAP, f, n);
+}
@@ -26,6 +26,20 @@
   extern "C" {
 #endif /* BDD_CPP */
 
+#define RECONF_NUM_STATS 12
+
+/* the largest k for jump_element_and (every state of it is cached) */
+#define RECONF_JUMP_MAXK 7
+
+/* Counters of an operator: the number of recursive calls, cache lookups,
+   cache hits and nodes obtained by getzbddp. */
+struct reconf_stat {
+    unsigned long long calls;
+    unsigned long long lookups;
+    unsigned long long hits;
+    unsigned long long nodes;
+};
+
 extern bddp   remove_element B_ARG((bddp f));
 extern bddp   remove_specified_element B_ARG((bddp f, int* elements));
 extern bddp   add_element B_ARG((bddp f, int n));
@@ -33,6 +47,19 @@ extern bddp   add_specified_element B_ARG((bddp f, int* elements));
 extern bddp   swap_element B_ARG((bddp f, int n));
 extern bddp   swap_specified_element B_ARG((bddp f, int* elements));
 extern bddp   swap_adjacent_element B_ARG((bddp f, int* elements, int** adjacent));
+extern bddp   remove_element_and B_ARG((bddp f, bddp g));
+extern bddp   add_element_and B_ARG((bddp f, bddp g));
+extern bddp   swap_element_and B_ARG((bddp f, bddp g));
+extern bddp   within_distance B_ARG((bddp f, bddp g, int d));
+extern bddp   jump_element_and B_ARG((bddp f, bddp g, int k));
+extern bddp   remove_element_bf B_ARG((bddp f));
+extern bddp   add_element_bf B_ARG((bddp f, int n));
+extern bddp   swap_element_bf B_ARG((bddp f, int n));
+extern int*   reconf_intern_elements B_ARG((const int* elements));
+extern int    reconf_intern_adjacent B_ARG((const int* elements, int* const* adjacent, int n, int** elements_out, int*** adjacent_out));
+extern void   reconf_get_stat B_ARG((int i, struct reconf_stat* stat));
+extern const char* reconf_stat_name B_ARG((int i));
+extern void   reconf_clear_stats B_ARG((void));
 
 #ifdef BDD_CPP
   }
@@ -34,6 +34,7 @@
 #include <vector>
 #include <list>
 #include <set>
+#include <map>
 #include <string>
 #include <cctype>
 #include <iostream>
@@ -43,6 +44,9 @@
 #include <functional>
 #include <time.h>
 #include <sys/time.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 using namespace tdzdd;
 using namespace sbddh;
@@ -62,6 +66,8 @@ enum Model {TJ, TS, TAR};
 #include "SteinerSubgraph.hpp"
 #include "ConnectedInducedSubgraph.hpp"
 
+#include "VertexOrder.hpp"
+#include "EdgeOrder.hpp"
 #include "Reconf.hpp"
 
 #include "MaxEval.hpp"
@@ -77,18 +83,54 @@ int main(int argc, char** argv) {
         std::cout << "[option]" << std::endl;
         std::cout << "  --randstart: randomly generates"
                   << " a start set" << std::endl;
+        std::cout << "  --startmax: starts from all the maximum sets"
+                  << " instead of s" << std::endl;
+        std::cout << "  --startfile=<file_name>: starts from all the sets"
+                  << " in the ZDD stored in <file_name>" << std::endl;
         std::cout << "  --st: computes the reconf sequence from s to t"
                   << std::endl;
         std::cout << "  --stb: computes the reconf sequence from s to t in the bidirection"
                   << std::endl;
+        std::cout << "  --stbal: same as --stb but extends the side"
+                  << " with the smaller last layer" << std::endl;
         std::cout << "  --stwidth: computes the width of the solution space graph"
                   << std::endl;
+        std::cout << "  --stspace=<prefix>: stores the sets on shortest"
+                  << " reconf seqs of each step into <prefix><step>"
+                  << std::endl;
+        std::cout << "  --stsample=<k>: outputs <k> shortest reconf seqs"
+                  << " chosen uniformly at random" << std::endl;
         std::cout << "  --stfile=<file_name>: specifies s and t"
                   << " in file <file_name>" << std::endl;
+        std::cout << "  --tfile=<file_name>: computes the reconf sequences"
+                  << " from s to every t in file <file_name>" << std::endl;
         std::cout << "  --longest: computes the longest reconf seq"
                   << std::endl;
         std::cout << "  --gc: force to run GC periodically"
                   << std::endl;
+        std::cout << "  --zdddir=<dir>: stores the ZDDs of the layers"
+                  << " into files in <dir>" << std::endl;
+        std::cout << "  --checkpoint[=<k>]: keeps only every k-th layer"
+                  << " (about sqrt(#steps) if k is omitted)" << std::endl;
+        std::cout << "  --procs=<n>: expands each layer by <n> processes"
+                  << std::endl;
+        std::cout << "  --conj[=<g>]: constructs the solution space by"
+                  << " intersecting the ZDDs of the constraints"
+                  << " (grouping every <g> constraints)" << std::endl;
+        std::cout << "  --vorder: reorders the vertices to reduce"
+                  << " the frontier width (for vertex variables)" << std::endl;
+        std::cout << "  --eorder: reorders the edges to reduce"
+                  << " the frontier size (for edge variables)" << std::endl;
+        std::cout << "  --threads=<n>: constructs the solution space"
+                  << " by <n> threads" << std::endl;
+        std::cout << "  --bf: uses the level-synchronous operators"
+                  << " for the neighbors (for TJ and TAR)" << std::endl;
+        std::cout << "  --prune=<u>: prunes the sets too far from t"
+                  << " assuming that #steps <= <u> (for --st)" << std::endl;
+        std::cout << "  --hybrid=<n>: stores the layers with at most <n>"
+                  << " sets explicitly (for --st)" << std::endl;
+        std::cout << "  --stats[=<file>]: outputs the statistics of the"
+                  << " operators (and of each step into <file>)" << std::endl;
         std::cout << "  --rainbow: for rainbow spanning trees"
                   << std::endl;
         std::cout << "  --info: outputs info to stderr (default on)"
@@ -97,10 +139,14 @@ int main(int argc, char** argv) {
                   << std::endl;
         std::cout << "[model]" << std::endl;
         std::cout << "  --tj: token jumping model (default)" << std::endl;
-        std::cout << "  --ts: token sliding model "
-                  << "(currently not implemented)" << std::endl;
+        std::cout << "  --tj=<k>: token jumping model where at most <k>"
+                  << " tokens jump at once (k <= 7)" << std::endl;
+        std::cout << "  --ts: token sliding model" << std::endl;
         std::cout << "  --tar=<k>: token addition/removal model "
                   << "(<k> is an integer)" << std::endl;
+        std::cout << "  --tar=<lo>:<hi>: token addition/removal model "
+                  << "with <lo> <= |X| <= <hi> (<lo> or <hi> can be omitted)"
+                  << std::endl;
         std::cout << "[sol_kind]" << std::endl;
         std::cout << "  --indset: independent set (default)" << std::endl;
         std::cout << "  --clique: clique" << std::endl;
@@ -152,6 +198,10 @@ int main(int argc, char** argv) {
                                 option.isEdgeVariable());
 #endif
 
+    // The SAPPOROBDD operations between the steps (intersection,
+    // difference, union, counting) still recurse once per variable,
+    // so the limit holds even when the level-synchronous operators
+    // of --bf are used.
     if (option.isEdgeVariable()) {
         if (graph.edgeSize() >= recursion_limit) {
             std::cerr << "The number of edges must be less than "
@@ -175,32 +225,133 @@ int main(int argc, char** argv) {
                      &start_set, &goal_set, option.isEdgeVariable());
     }
 
+    std::vector<std::set<bddvar> > goal_sets;
+    if (option.t_file) {
+        parse_tfile(option.t_filename.c_str(), &graph,
+                    &goal_sets, option.isEdgeVariable());
+    }
+
     if (option.show_info) {
         std::cerr << "Input graph file parsed. "
                   << "# of vertices = " << num_vertices
                   << ", # of edges = " << graph.edgeSize() << std::endl;
-        if (!option.rand_start) {
+        if (!option.rand_start && !option.isStartFamily()) {
             std::cerr << "s ";
             printSet(std::cerr, start_set, graph, option.isEdgeVariable());
         }
-        if (!option.longest_mode) {
+        if (option.t_file) {
+            std::cerr << "# of t = " << goal_sets.size() << std::endl;
+        } else if (!option.longest_mode) {
             std::cerr << "t ";
             printSet(std::cerr, goal_set, graph, option.isEdgeVariable());
         }
     }
 
-    if (option.st_mode && start_set == goal_set) {
+    // var_map[v]: the variable that the variable v of the input numbering
+    // becomes after --vorder or --eorder (empty if the order is not changed)
+    std::vector<bddvar> var_map;
+    if (option.is_vorder && !option.isEdgeVariable()) {
+        // relabel the vertices in the Cuthill-McKee order, keeping
+        // their names, so that the output is in the original numbers
+        int width = getVertexFrontierWidth(graph);
+        Graph reordered_graph;
+        reorderGraph(graph, getCuthillMcKeeOrder(graph), &reordered_graph);
+        int new_width = getVertexFrontierWidth(reordered_graph);
+        if (option.show_info) {
+            std::cerr << "Vertex frontier width = " << width
+                      << " -> " << new_width
+                      << (new_width < width ? "" : " (not reordered)")
+                      << std::endl;
+        }
+        if (new_width < width) {
+            start_set = remapVertexSet(start_set, graph, reordered_graph);
+            goal_set = remapVertexSet(goal_set, graph, reordered_graph);
+            for (size_t i = 0; i < goal_sets.size(); ++i) {
+                goal_sets[i] = remapVertexSet(goal_sets[i], graph,
+                                              reordered_graph);
+            }
+            var_map.resize(num_vertices + 1);
+            for (int v = 0; v <= num_vertices; ++v) {
+                var_map[v] = (1 <= v && v <= graph.vertexSize()
+                              ? reordered_graph.getVertex(graph.vertexName(v))
+                              : v);
+            }
+            graph = reordered_graph;
+        }
+    }
+
+    if (option.st_mode && !option.t_file && !option.isStartFamily()
+        && start_set == goal_set) {
         // Output for 0 step
         std::cout << "a ";
         printSet(std::cout, start_set, graph, option.isEdgeVariable());
         return 0;
     }
 
+    // edge_numbers[j]: the edge number in the input of the edge j
+    // (empty if the edges are not reordered)
+    std::vector<int> edge_numbers;
+    if (option.is_eorder && option.isEdgeVariable()) {
+        // put the edges in the order along the Cuthill-McKee order
+        // of the vertices, which the frontier-based constructions follow
+        Graph reordered_graph;
+        std::vector<int> numbers;
+        reorderEdges(graph, &reordered_graph, &numbers);
+        int size = graph.maxFrontierSize();
+        int new_size = reordered_graph.maxFrontierSize();
+        if (option.show_info) {
+            std::cerr << "Max frontier size = " << size
+                      << " -> " << new_size
+                      << (new_size < size ? "" : " (not reordered)")
+                      << std::endl;
+        }
+        if (new_size < size) {
+            edge_numbers = numbers;
+            start_set = remapEdgeSet(start_set, edge_numbers);
+            goal_set = remapEdgeSet(goal_set, edge_numbers);
+            for (size_t i = 0; i < goal_sets.size(); ++i) {
+                goal_sets[i] = remapEdgeSet(goal_sets[i], edge_numbers);
+            }
+            if (!colors.empty()) {
+                std::vector<int> new_colors(colors.size(), 0);
+                for (size_t j = 1; j < edge_numbers.size(); ++j) {
+                    if (j < colors.size()
+                        && static_cast<size_t>(edge_numbers[j]) < colors.size()) {
+                        new_colors[j] = colors[edge_numbers[j]];
+                    }
+                }
+                colors = new_colors;
+            }
+            // The variable of the edge e is m + 1 - e.
+            const int m = graph.edgeSize();
+            var_map.assign(m + 1, 0);
+            for (int j = 1; j <= m; ++j) {
+                var_map[m + 1 - edge_numbers[j]] = m + 1 - j;
+            }
+            graph = reordered_graph;
+        }
+    }
+
     if (option.isEdgeVariable()) {
         // change edge IDs to SAPPOROBDD variable numbers
         // from 1,...,m to m,...,1
         start_set = inverseSet(start_set, graph.edgeSize() + 1);
         goal_set = inverseSet(goal_set, graph.edgeSize() + 1);
+        for (size_t i = 0; i < goal_sets.size(); ++i) {
+            goal_sets[i] = inverseSet(goal_sets[i], graph.edgeSize() + 1);
+        }
+    }
+
+    // parallel construction of the DdStructures (--threads)
+    bool use_mp = false;
+    if (option.num_threads >= 2) {
+#ifdef _OPENMP
+        omp_set_num_threads(option.num_threads);
+        use_mp = true;
+#else
+        std::cerr << "Compiled without OpenMP, so --threads is ignored."
+                  << std::endl;
+#endif
     }
 
     int col = 1;
@@ -288,11 +439,18 @@ int main(int argc, char** argv) {
         std::cerr << "Solution space ZDD construction start" << std::endl;
     }
 
+    space->setUseMultiProcessors(use_mp);
+    if (option.is_conj) {
+        space->setConjunctionScheduler(option.conj_group_size);
+    }
+
     double start_time = getTime();
+    double start_cpu_time = getCpuTime();
 
     solution_space_zdd = space->createSolutionSpaceZdd();
 
     double end_time = getTime();
+    double end_cpu_time = getCpuTime();
 
     if (option.show_info) {
         std::cerr << "Solution space ZDD construction end" << std::endl;
@@ -302,6 +460,18 @@ int main(int argc, char** argv) {
 
         std::cerr << "Solution space ZDD construction time = "
                   << (end_time - start_time) << std::endl;
+        if (use_mp && end_time > start_time) {
+            // The CPU time of all the threads divided by the wall-clock
+            // time is the average number of busy threads. It is not
+            // a speedup: idle OpenMP workers may spin, and the sequential
+            // parts (such as ToZBDD) are included.
+            std::cerr << "Solution space ZDD construction CPU time = "
+                      << (end_cpu_time - start_cpu_time) << " ("
+                      << option.num_threads << " threads, average parallelism = "
+                      << (end_cpu_time - start_cpu_time)
+                         / (end_time - start_time)
+                      << ")" << std::endl;
+        }
 
         std::cerr << "Solution space ZDD size = "
                   << solution_space_zdd.Size() << std::endl;
@@ -326,16 +496,11 @@ int main(int argc, char** argv) {
     // Randomly generate the start set.
     if (option.rand_start) {
         if (option.rand_max) {
-            SapporoZdd sz(solution_space_zdd);
-            DdStructure<2> dds(sz);
-            int max_value = dds.evaluate(MaxEval());
             int num_elements = (option.isEdgeVariable()
                                 ? graph.edgeSize() : num_vertices);
-            IntRange at_least_k(max_value, num_elements);
-            SizeConstraint sc(num_elements, at_least_k);
-            DdStructure<2> ddm(sc);
-            ZBDD sczdd = ddm.evaluate(ToZBDD());
-            ZBDD solution_space_max_zdd = solution_space_zdd & sczdd;
+            ZBDD solution_space_max_zdd = getMaximumSets(solution_space_zdd,
+                                                         num_elements,
+                                                         use_mp);
             start_set = pickRandomly(solution_space_max_zdd, random);
         } else {
             start_set = pickRandomly(solution_space_zdd, random);
@@ -345,7 +510,8 @@ int main(int argc, char** argv) {
             std::cerr << "s ";
             if (option.isEdgeVariable()) {
                 std::set<bddvar> start_set_rev =
-                    inverseSet(start_set,graph.edgeSize() + 1);
+                    restoreEdgeSet(inverseSet(start_set,graph.edgeSize() + 1),
+                                   edge_numbers);
                 printSet(std::cerr, start_set_rev, graph,
                          option.isEdgeVariable());
             } else {
@@ -355,30 +521,132 @@ int main(int argc, char** argv) {
         }
     }
 
+    // The family of the start sets
+    ZBDD start_zdd = ZBDD(-1);
+    if (option.start_max) {
+        int num_elements = (option.isEdgeVariable()
+                            ? graph.edgeSize() : num_vertices);
+        start_zdd = getMaximumSets(solution_space_zdd, num_elements,
+                                   use_mp);
+        if (option.show_info) {
+            std::cerr << "# of maximum sets = "
+                      << getCard(start_zdd) << std::endl;
+        }
+    } else if (option.start_file) {
+        FILE* fp = fopen(option.start_filename.c_str(), "r");
+        if (fp == NULL) {
+            std::cerr << "File " << option.start_filename
+                      << " cannot be opened." << std::endl;
+            exit(1);
+        }
+        start_zdd = ZBDD_Import(fp);
+        fclose(fp);
+        if (start_zdd == ZBDD(-1)) {
+            std::cerr << "File " << option.start_filename
+                      << " cannot be read." << std::endl;
+            exit(1);
+        }
+        if (!var_map.empty()) {
+            // The file is in the numbering of the input.
+            if (static_cast<size_t>(start_zdd.Top()) >= var_map.size()) {
+                std::cerr << "File " << option.start_filename
+                          << " has the variable " << start_zdd.Top()
+                          << ", which is out of the input." << std::endl;
+                exit(1);
+            }
+            start_zdd = permuteVariables(start_zdd, var_map);
+        }
+    }
+
     start_time = getTime();
 
     Reconf reconf(random, space->getNumElements(), graph,
                   option.isEdgeVariable(),
                   option.show_info, option.is_gc);
 
+    if (!edge_numbers.empty()) {
+        reconf.setEdgeNumbers(edge_numbers);
+    }
+    if (!var_map.empty()) {
+        std::vector<bddvar> input_var_map(var_map.size(), 0);
+        for (size_t v = 0; v < var_map.size(); ++v) {
+            input_var_map[var_map[v]] = static_cast<bddvar>(v);
+        }
+        reconf.setInputVariableMap(input_var_map);
+    }
     if (option.zdd_dir) {
         reconf.setZddDir(option.zdd_dirname);
     }
+    if (option.stb_balanced) {
+        reconf.setBalancedBidirection();
+    }
+    if (option.is_checkpoint) {
+        reconf.setCheckpoint(option.checkpoint_interval);
+    }
+    if (option.is_bf) {
+        reconf.setBreadthFirst();
+    }
+    if (option.is_prune) {
+        reconf.setPruning(option.prune_bound);
+    }
+    if (option.num_procs >= 2) {
+        reconf.setNumProcs(option.num_procs);
+    }
+    if (option.hybrid_threshold > 0) {
+        reconf.setHybrid(option.hybrid_threshold);
+    }
+    if (option.is_stats) {
+        reconf.setStats();
+    }
 
     if (option.model == TJ) {
+        reconf.setJumpSize(option.tj_k);
+        reconf.setSolutionSpaceZdd(solution_space_zdd);
+    } else if (option.model == TS) {
+        reconf.setModelTs();
         reconf.setSolutionSpaceZdd(solution_space_zdd);
     } else if (option.model == TAR) {
         reconf.setModelTar();
-        reconf.setSolutionSpaceZddTar(solution_space_zdd, option.tar_k);
+        reconf.setSolutionSpaceZddTar(solution_space_zdd, option.tar_k,
+                                      option.tar_k_max);
     }
 
-    if (option.stb_mode) {
+    if (option.isStartFamily() && option.st_mode) {
+        if (option.show_info) {
+            std::cerr << "Start searching a reconfiguration sequence "
+                      << "from the start sets to t"
+                      << std::endl;
+        }
+        reconf.findReconfSeqFromFamily(start_zdd, goal_set);
+    } else if (option.t_file) {
+        if (option.show_info) {
+            std::cerr << "Start searching reconfiguration sequences "
+                      << "from s to all the t's"
+                      << std::endl;
+        }
+        reconf.findReconfSeqMulti(start_set, goal_sets);
+    } else if (option.stb_mode) {
         if (option.show_info) {
             std::cerr << "Start searching a reconfiguration sequence "
                       << "from s to t in the bidirection"
                       << std::endl;
         }
         reconf.findReconfSeqBoth(start_set, goal_set);
+    } else if (option.num_samples > 0) {
+        if (option.show_info) {
+            std::cerr << "Start sampling shortest "
+                      << "reconfiguration sequences"
+                      << std::endl;
+        }
+        reconf.findUniformShortestSeqs(start_set, goal_set,
+                                       option.num_samples);
+    } else if (option.sts_mode) {
+        if (option.show_info) {
+            std::cerr << "Start computing the sets on "
+                      << "shortest reconfiguration sequences"
+                      << std::endl;
+        }
+        reconf.findShortestSpace(start_set, goal_set, option.sts_prefix);
     } else if (option.stw_mode) {
         if (option.show_info) {
             std::cerr << "Start computing the width of the solution space graph"
@@ -407,5 +675,11 @@ int main(int argc, char** argv) {
         std::cerr << "Reconfiguration time = "
                   << (end_time - start_time) << std::endl;
     }
+    if (option.is_stats) {
+        reconf.printStats(std::cerr);
+        if (!option.stats_filename.empty()) {
+            reconf.writeStepStats(option.stats_filename);
+        }
+    }
     return 0;
 }